@@ -162,6 +162,16 @@ void bdfPrintCharacter(BDF_FONT *font, int x, int y, int character);
 void bdfSetDrawingFunction(void (*drawFunc)(int x, int y, int c, void *ctx),
                            void *ctx);
 
+/**
+ * Get the drawing function and context set by bdfSetDrawingFunction(),
+ * so that they can be restored after drawing with others.
+ * @param drawFunc Set to the drawing function.
+ * @param ctx Set to its context pointer.
+ */
+
+void bdfGetDrawingFunction(void (**drawFunc)(int x, int y, int c, void *ctx),
+                           void **ctx);
+
 /**
  * Set the size of the drawing area.
  * The drawing area width and height are just hints, if you know what
@@ -183,6 +193,14 @@ void bdfSetDrawingFunction(void (*drawFunc)(int x, int y, int c, void *ctx),
 
 void bdfSetDrawingAreaSize(int width, int height);
 
+/**
+ * Get the drawing area size set by bdfSetDrawingAreaSize().
+ * @param width Set to the screen width
+ * @param height Set to the screen height
+ */
+
+void bdfGetDrawingAreaSize(int *width, int *height);
+
 /**
  * Enable or disable word wrap.
  * @param enabled TRUE (1) to enable word wrap, FALSE (0) to disable it.
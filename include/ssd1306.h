@@ -29,6 +29,114 @@ extern "C" {
 
 typedef void *ssd1306_handle_t; /*handle of ssd1306*/
 
+/**
+ * @brief  Bytes of a caller-provided framebuffer for ssd1306_create_static().
+ *         The first byte is the I2C data prefix, so a full refresh sends the
+ *         buffer as is.
+ */
+#define SSD1306_FRAMEBUFFER_SIZE (1 + SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+
+/**
+ * @brief  Bytes of a DIFF mode shadow buffer for ssd1306_set_shadow_buffer().
+ */
+#define SSD1306_SHADOW_SIZE (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+
+#define SSD1306_DEVICE_STORAGE_SIZE (480 + 16 * sizeof(void *))
+
+/**
+ * @brief  Caller-provided storage for a device object, see
+ *         ssd1306_create_static(). Its contents are private.
+ */
+typedef union {
+  uint64_t align;
+  uint8_t bytes[SSD1306_DEVICE_STORAGE_SIZE];
+} ssd1306_storage_t;
+
+/**
+ * @brief  A point, for batched drawing
+ */
+typedef struct {
+  uint8_t x;
+  uint8_t y;
+} ssd1306_point_t;
+
+/**
+ * @brief  A horizontal or vertical run of pixels, for batched drawing
+ */
+typedef struct {
+  uint8_t x;   /*!< X position of the first pixel */
+  uint8_t y;   /*!< Y position of the first pixel */
+  uint8_t len; /*!< number of pixels */
+} ssd1306_span_t;
+
+/**
+ * @brief  How ssd1306_refresh_gram transfers the framebuffer
+ */
+typedef enum {
+  SSD1306_REFRESH_FULL = 0, /*!< send the whole framebuffer on every refresh */
+  SSD1306_REFRESH_DIFF,     /*!< send only what differs from the panel GRAM */
+} ssd1306_refresh_mode_t;
+
+/**
+ * @brief  Display rotation, clockwise
+ */
+typedef enum {
+  SSD1306_ROTATION_0 = 0,
+  SSD1306_ROTATION_90,  /*!< portrait, 64x128 */
+  SSD1306_ROTATION_180,
+  SSD1306_ROTATION_270, /*!< portrait, 64x128 */
+} ssd1306_rotation_t;
+
+/**
+ * @brief  Counters kept by the paced refresh task
+ */
+typedef struct {
+  uint32_t frames_sent;    /*!< frames transferred to the panel */
+  uint32_t frames_merged;  /*!< requests folded into a frame already pending */
+  uint32_t frames_skipped; /*!< periods without any refresh request */
+  uint32_t frames_dropped; /*!< transfers that failed, retried next period */
+  uint32_t periods_missed; /*!< periods overrun by a slow transfer */
+} ssd1306_pacing_stats_t;
+
+/**
+ * @brief  Bus error handling
+ *
+ * A refresh sends at most ceil(bytes / 128) chunks in chunked mode, each
+ * tried 1 + retries times, so its worst-case latency is bounded by
+ * chunks * (1 + retries) * (2 * timeout_ms + backoff_max_ms), plus one
+ * panel re-init when reinit_after is reached.
+ */
+typedef struct {
+  uint32_t timeout_ms;     /*!< timeout of a single I2C transfer */
+  uint8_t retries;         /*!< extra attempts for a failed chunk or window */
+  uint16_t backoff_ms;     /*!< wait before the first retry, doubled after */
+  uint16_t backoff_max_ms; /*!< upper bound of the retry wait */
+  uint8_t reinit_after; /*!< consecutive failures that trigger a bus reset and
+                             panel re-init, 0 to never re-init */
+  bool chunked; /*!< split refreshes into windows of at most 128 data bytes,
+                     retried on their own */
+  i2c_master_bus_handle_t bus_handle; /*!< bus to reset on recovery, or NULL */
+} ssd1306_bus_config_t;
+
+#define SSD1306_BUS_CONFIG_DEFAULT()                                           \
+  {                                                                            \
+    .timeout_ms = 1000, .retries = 0, .backoff_ms = 0, .backoff_max_ms = 0,    \
+    .reinit_after = 0, .chunked = false, .bus_handle = NULL,                   \
+  }
+
+/**
+ * @brief  Panel state kept across deep sleep for ssd1306_warm_start(),
+ *         typically in an RTC_NOINIT_ATTR or RTC_DATA_ATTR variable
+ */
+typedef struct {
+  uint32_t magic;
+  uint8_t rotation; /*!< ssd1306_rotation_t */
+  bool mirror_x;
+  bool mirror_y;
+  uint8_t gram[SSD1306_SHADOW_SIZE]; /*!< what the panel shows */
+  uint32_t crc;                      /*!< over all fields above */
+} ssd1306_retained_t;
+
 /**
  * @brief   device initialization
  *
@@ -47,9 +155,80 @@ esp_err_t ssd1306_init(ssd1306_handle_t dev);
  *
  * @return
  *     - device object handle of ssd1306
+ *     - NULL if out of memory
  */
 ssd1306_handle_t ssd1306_create(i2c_master_dev_handle_t i2c_dev_handle);
 
+/**
+ * @brief   Create a device object in caller-provided memory, without heap
+ *          allocation and without talking to the panel
+ *
+ * The panel is left untouched; call ssd1306_init() once the bus is up, or
+ * ssd1306_warm_start() if the panel kept its state.
+ *
+ * @param   i2c_dev_handle i2c device handle
+ * @param   storage memory for the device object, must outlive the handle
+ * @param   framebuffer SSD1306_FRAMEBUFFER_SIZE bytes, must outlive the handle
+ *
+ * @return
+ *     - device object handle of ssd1306
+ *     - NULL if storage or framebuffer is NULL
+ */
+ssd1306_handle_t ssd1306_create_static(i2c_master_dev_handle_t i2c_dev_handle,
+                                       ssd1306_storage_t *storage,
+                                       uint8_t *framebuffer);
+
+/**
+ * @brief   Give the device a caller-provided shadow buffer, so that
+ *          SSD1306_REFRESH_DIFF mode needs no heap allocation
+ *
+ * The buffer is kept when switching back to SSD1306_REFRESH_FULL and is
+ * never freed by the driver.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   buffer SSD1306_SHADOW_SIZE bytes, must outlive the handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG buffer is NULL
+ */
+esp_err_t ssd1306_set_shadow_buffer(ssd1306_handle_t dev, uint8_t *buffer);
+
+/**
+ * @brief   Record what the panel shows, for ssd1306_warm_start() after the
+ *          next wake-up
+ *
+ * Call it after the last refresh before entering deep sleep, with the panel
+ * left powered.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   retained state to fill in
+ *
+ * @return
+ *     - ESP_OK Success
+ */
+esp_err_t ssd1306_save_retained(ssd1306_handle_t dev,
+                                ssd1306_retained_t *retained);
+
+/**
+ * @brief   Take over a panel that kept its power and GRAM, instead of
+ *          ssd1306_init()
+ *
+ * Restores orientation and framebuffer from the retained state and marks
+ * the shadow valid, so the next refresh in SSD1306_REFRESH_DIFF mode only
+ * sends what changed. Nothing is sent to the panel. Fall back to
+ * ssd1306_init() when this fails.
+ *
+ * @param   dev object handle of ssd1306, not initialised yet
+ * @param   retained state saved by ssd1306_save_retained()
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_CRC retained state is missing or corrupt (cold boot)
+ */
+esp_err_t ssd1306_warm_start(ssd1306_handle_t dev,
+                             const ssd1306_retained_t *retained);
+
 /**
  * @brief   Delete and release a device object
  *
@@ -108,6 +287,153 @@ void ssd1306_draw_bitmap(ssd1306_handle_t dev, uint8_t chXpos, uint8_t chYpos,
 void ssd1306_draw_line(ssd1306_handle_t dev, int16_t chXpos1, int16_t chYpos1,
                        int16_t chXpos2, int16_t chYpos2);
 
+/**
+ * @brief   draw an array of points
+ *
+ * Same result as calling ssd1306_fill_point for each point, with the
+ * per-call overhead paid once for the batch.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   points points to draw
+ * @param   count number of points
+ * @param   chPoint fill point
+ */
+void ssd1306_fill_points(ssd1306_handle_t dev, const ssd1306_point_t *points,
+                         size_t count, uint8_t chPoint);
+
+/**
+ * @brief   draw an array of horizontal spans
+ *
+ * @param   dev object handle of ssd1306
+ * @param   spans spans to draw, each extending to the right of (x, y)
+ * @param   count number of spans
+ * @param   chPoint fill point
+ */
+void ssd1306_fill_hspans(ssd1306_handle_t dev, const ssd1306_span_t *spans,
+                         size_t count, uint8_t chPoint);
+
+/**
+ * @brief   draw an array of vertical spans
+ *
+ * @param   dev object handle of ssd1306
+ * @param   spans spans to draw, each extending down from (x, y)
+ * @param   count number of spans
+ * @param   chPoint fill point
+ */
+void ssd1306_fill_vspans(ssd1306_handle_t dev, const ssd1306_span_t *spans,
+                         size_t count, uint8_t chPoint);
+
+/**
+ * @brief   plot a waveform of one y sample per column
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos X position of the first sample
+ * @param   pchSamples Y position of each sample
+ * @param   count number of samples
+ * @param   connect whether to join consecutive samples with vertical runs,
+ *          or plot the samples as single points
+ */
+void ssd1306_draw_waveform(ssd1306_handle_t dev, uint8_t chXpos,
+                           const uint8_t *pchSamples, size_t count,
+                           bool connect);
+
+/**
+ * @brief   Invert the pixels of rectangle (x1,y1)-(x2,y2)
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1
+ * @param   chYpos1
+ * @param   chXpos2
+ * @param   chYpos2
+ */
+void ssd1306_invert_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                           uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2);
+
+/**
+ * @brief   XOR a pattern over rectangle (x1,y1)-(x2,y2)
+ *
+ * Column x uses pattern byte x % len, repeated down every 8-row band with
+ * bit 7 on the band's first row; {0xAA, 0x55} gives a checkerboard.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1
+ * @param   chYpos1
+ * @param   chXpos2
+ * @param   chYpos2
+ * @param   pchPattern column pattern bytes
+ * @param   chPatternLen number of pattern bytes
+ */
+void ssd1306_xor_pattern(ssd1306_handle_t dev, uint8_t chXpos1,
+                         uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                         const uint8_t *pchPattern, uint8_t chPatternLen);
+
+/**
+ * @brief   Scroll the content of rectangle (x1,y1)-(x2,y2) by (dx, dy)
+ *
+ * Content leaving the rectangle is dropped and the area it vacates is
+ * filled with chFill.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1
+ * @param   chYpos1
+ * @param   chXpos2
+ * @param   chYpos2
+ * @param   dx pixels to the right, negative to the left
+ * @param   dy pixels down, negative up
+ * @param   chFill fill point for the vacated area
+ */
+void ssd1306_scroll_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                           uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                           int16_t dx, int16_t dy, uint8_t chFill);
+
+/**
+ * @brief   Scroll the whole screen by (dx, dy)
+ *
+ * @param   dev object handle of ssd1306
+ * @param   dx pixels to the right, negative to the left
+ * @param   dy pixels down, negative up
+ * @param   chFill fill point for the vacated area
+ */
+void ssd1306_scroll(ssd1306_handle_t dev, int16_t dx, int16_t dy,
+                    uint8_t chFill);
+
+/**
+ * @brief   Copy rectangle (x1,y1)-(x2,y2) so its top-left corner lands on
+ *          (dstX, dstY)
+ *
+ * Source and destination may overlap.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1
+ * @param   chYpos1
+ * @param   chXpos2
+ * @param   chYpos2
+ * @param   chDstX destination X position
+ * @param   chDstY destination Y position
+ */
+void ssd1306_copy_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                         uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                         int16_t chDstX, int16_t chDstY);
+
+/**
+ * @brief   Move rectangle (x1,y1)-(x2,y2) to (dstX, dstY)
+ *
+ * Like ssd1306_copy_region, then fills the part of the source not covered
+ * by the destination with chFill.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1
+ * @param   chYpos1
+ * @param   chXpos2
+ * @param   chYpos2
+ * @param   chDstX destination X position
+ * @param   chDstY destination Y position
+ * @param   chFill fill point for the vacated area
+ */
+void ssd1306_move_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                         uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                         int16_t chDstX, int16_t chDstY, uint8_t chFill);
+
 /**
  * @brief   load a BDF font via buffer
  *
@@ -150,6 +476,220 @@ void ssd1306_draw_bdf_text(ssd1306_handle_t dev, uint8_t chXpos, uint8_t chYpos,
  **/
 esp_err_t ssd1306_refresh_gram(ssd1306_handle_t dev);
 
+/**
+ * @brief   Select how the framebuffer is sent on refresh
+ *
+ * In SSD1306_REFRESH_DIFF mode the driver keeps a shadow copy of the panel
+ * GRAM (1 KB, allocated here) and every refresh compares the framebuffer
+ * against it, sending only the changed areas as a few GRAM windows. This
+ * works for applications that redraw the whole frame each time, and the first
+ * refresh after enabling it is a full transfer.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   mode refresh mode
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NO_MEM Shadow buffer could not be allocated
+ **/
+esp_err_t ssd1306_set_refresh_mode(ssd1306_handle_t dev,
+                                   ssd1306_refresh_mode_t mode);
+
+/**
+ * @brief   Forget what the panel GRAM holds
+ *
+ * The next refresh sends the whole framebuffer. Call this if the panel may
+ * have lost its contents, e.g. after a power cycle.
+ *
+ * @param   dev object handle of ssd1306
+ **/
+void ssd1306_invalidate_gram(ssd1306_handle_t dev);
+
+/**
+ * @brief   Restrict drawing to a rectangle
+ *
+ * Points, lines, rectangles, bitmaps, BDF text, blits and the region and
+ * batched operations leave everything outside the clip rectangle untouched.
+ * ssd1306_clear_screen is not clipped. Rotating the display resets the clip.
+ *
+ * @param   dev object handle of ssd1306 or a canvas
+ * @param   chXpos1 Specifies the X position 1
+ * @param   chYpos1 Specifies the Y position 1
+ * @param   chXpos2 Specifies the X position 2
+ * @param   chYpos2 Specifies the Y position 2
+ **/
+void ssd1306_set_clip(ssd1306_handle_t dev, uint8_t chXpos1, uint8_t chYpos1,
+                      uint8_t chXpos2, uint8_t chYpos2);
+
+/**
+ * @brief   Allow drawing anywhere again
+ *
+ * @param   dev object handle of ssd1306 or a canvas
+ **/
+void ssd1306_reset_clip(ssd1306_handle_t dev);
+
+/**
+ * @brief   Mark a rectangle of the framebuffer as changed
+ *
+ * For code that tracks its own changes: ssd1306_refresh_dirty then sends
+ * only the marked areas, merged into as few GRAM windows as pays off.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1 Specifies the X position 1
+ * @param   chYpos1 Specifies the Y position 1
+ * @param   chXpos2 Specifies the X position 2
+ * @param   chYpos2 Specifies the Y position 2
+ **/
+void ssd1306_mark_dirty(ssd1306_handle_t dev, uint8_t chXpos1,
+                        uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2);
+
+/**
+ * @brief   Send the areas marked with ssd1306_mark_dirty
+ *
+ * Marks are cleared once sent, and by ssd1306_refresh_gram. In
+ * SSD1306_REFRESH_DIFF mode marked pages that still match the panel are
+ * skipped, and the whole framebuffer is sent if the panel contents are
+ * unknown.
+ *
+ * @param   dev object handle of ssd1306
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Bus error, the marks are kept
+ **/
+esp_err_t ssd1306_refresh_dirty(ssd1306_handle_t dev);
+
+/**
+ * @brief   Set bus timeouts and error recovery
+ *
+ * With chunked refresh a failed chunk is retried on its own with a doubling
+ * backoff. After reinit_after consecutive failed transfers the bus is reset
+ * (when bus_handle is given) and the panel command sequence is sent again;
+ * the framebuffer is kept and the next refresh sends it whole.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   config settings, see SSD1306_BUS_CONFIG_DEFAULT
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG timeout_ms is zero
+ **/
+esp_err_t ssd1306_set_bus_config(ssd1306_handle_t dev,
+                                 const ssd1306_bus_config_t *config);
+
+/**
+ * @brief   Rotate the display
+ *
+ * 0 and 180 degrees are done by the panel's segment remap and COM scan
+ * direction at no drawing cost. 90 and 270 degrees additionally swap the
+ * drawing coordinates, so points, lines, rectangles, region operations,
+ * bitmaps and BDF text use a 64x128 area. Layers, compressed bitmaps and
+ * animations keep addressing the panel in its native orientation.
+ *
+ * Redraw and refresh the screen after changing the rotation: the panel only
+ * applies the new segment remap to data written afterwards.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   rotation rotation
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Unknown rotation
+ *     - ESP_FAIL Bus error
+ */
+esp_err_t ssd1306_set_rotation(ssd1306_handle_t dev,
+                               ssd1306_rotation_t rotation);
+
+/**
+ * @brief   Mirror the display horizontally and/or vertically
+ *
+ * Mirroring applies on top of the rotation, along the rotated axes, and is
+ * done entirely by the panel. Redraw and refresh as for
+ * ssd1306_set_rotation.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   mirror_x flip left and right
+ * @param   mirror_y flip top and bottom
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Bus error
+ */
+esp_err_t ssd1306_set_mirror(ssd1306_handle_t dev, bool mirror_x,
+                             bool mirror_y);
+
+/**
+ * @brief   Width of the drawing area, after rotation
+ *
+ * @param   dev object handle of ssd1306
+ */
+uint8_t ssd1306_get_width(ssd1306_handle_t dev);
+
+/**
+ * @brief   Height of the drawing area, after rotation
+ *
+ * @param   dev object handle of ssd1306
+ */
+uint8_t ssd1306_get_height(ssd1306_handle_t dev);
+
+/**
+ * @brief   Pixel storage of a display or canvas, for code that renders
+ *          straight into it (such as ssd1306.hpp)
+ *
+ * Columns of 8 page bytes in panel coordinates, before rotation: panel pixel
+ * (x, y) is bit 7 - y % 8 of byte x * 8 + 7 - y / 8. Writing here bypasses
+ * the clip and dirty tracking.
+ *
+ * @param   dev object handle of ssd1306, or a canvas handle
+ */
+uint8_t *ssd1306_get_framebuffer(ssd1306_handle_t dev);
+
+/**
+ * @brief   Start refreshing the panel from a driver-owned task
+ *
+ * Once started, producers call ssd1306_request_refresh instead of
+ * ssd1306_refresh_gram. The task sends at most one frame per period and
+ * skips periods in which nobody asked for a refresh. Combine with
+ * SSD1306_REFRESH_DIFF to send only what changed.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   fps target frame rate, limited by the FreeRTOS tick rate
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG fps is zero
+ *     - ESP_ERR_INVALID_STATE Paced refresh already running
+ *     - ESP_ERR_NO_MEM Task could not be created
+ **/
+esp_err_t ssd1306_start_paced_refresh(ssd1306_handle_t dev, uint32_t fps);
+
+/**
+ * @brief   Stop the paced refresh task, waiting for it to finish
+ *
+ * @param   dev object handle of ssd1306
+ **/
+void ssd1306_stop_paced_refresh(ssd1306_handle_t dev);
+
+/**
+ * @brief   Mark the framebuffer as needing a refresh
+ *
+ * Safe to call from any task; the paced refresh task sends the frame at its
+ * next period.
+ *
+ * @param   dev object handle of ssd1306
+ **/
+void ssd1306_request_refresh(ssd1306_handle_t dev);
+
+/**
+ * @brief   Read the paced refresh counters
+ *
+ * @param   dev object handle of ssd1306
+ * @param   stats receives the counters
+ * @param   reset whether to zero the counters afterwards
+ **/
+void ssd1306_get_pacing_stats(ssd1306_handle_t dev,
+                              ssd1306_pacing_stats_t *stats, bool reset);
+
 /**
  * @brief   Clear screen
  *
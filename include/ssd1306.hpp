@@ -0,0 +1,234 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Header-only C++ layer over the SSD1306 driver
+ *
+ * ssd1306::Display<W, H> draws straight into the framebuffer of a display
+ * handle with the geometry fixed at compile time, so bounds checks compare
+ * against constants and the primitives inline. Text uses constexpr glyph
+ * tables generated by tools/bdf2cpp.py, which end up in flash and need no
+ * font parsing at run time. The handle stays usable with every C function.
+ */
+
+#pragma once
+
+#include "ssd1306.h"
+#include <cstdint>
+#include <cstring>
+
+namespace ssd1306 {
+
+/**
+ * @brief  One glyph of a generated font, in BDF terms
+ */
+struct Glyph {
+  uint8_t width;    /*!< BBX width; bitmap rows are padded to whole bytes */
+  uint8_t height;   /*!< BBX height */
+  int8_t x_offset;  /*!< BBX x offset */
+  int8_t y_offset;  /*!< BBX y offset */
+  uint8_t advance;  /*!< DWIDTH x */
+  uint32_t bitmap;  /*!< offset of the first row in Font::bitmaps */
+};
+
+/**
+ * @brief  A generated font covering the character codes first..first+count-1
+ */
+struct Font {
+  const Glyph *glyphs;
+  const uint8_t *bitmaps;
+  uint16_t first;
+  uint16_t count;
+  uint8_t height;  /*!< FONTBOUNDINGBOX height */
+  int8_t y_offset; /*!< FONTBOUNDINGBOX y offset */
+
+  /**
+   * @brief   Glyph of a character code, or nullptr if the font has none
+   */
+  constexpr const Glyph *glyph(uint32_t code) const {
+    if (code < first || code - first >= count) {
+      return nullptr;
+    }
+    const Glyph *g = &glyphs[code - first];
+    return g->advance || g->width ? g : nullptr;
+  }
+};
+
+/**
+ * @brief  A 128x64 display, or 64x128 in portrait (rotated 90 or 270)
+ *
+ * Drawing clips to the display only: the clip set with ssd1306_set_clip and
+ * dirty tracking are left to the C functions.
+ */
+template <uint8_t W, uint8_t H> class Display {
+  static_assert((W == SSD1306_WIDTH && H == SSD1306_HEIGHT) ||
+                    (W == SSD1306_HEIGHT && H == SSD1306_WIDTH),
+                "Display is 128x64, or 64x128 in portrait");
+
+public:
+  static constexpr uint8_t width = W;
+  static constexpr uint8_t height = H;
+  static constexpr bool portrait = W < H;
+
+  /**
+   * @brief   Wrap a display handle, setting the rotation that matches W x H
+   *
+   * @param   handle display handle, not owned
+   * @param   flipped rotate by 180 (or 270) instead of 0 (or 90) degrees
+   */
+  explicit Display(ssd1306_handle_t handle, bool flipped = false)
+      : handle_(handle), fb_(ssd1306_get_framebuffer(handle)) {
+    ssd1306_set_rotation(handle_, portrait ? (flipped ? SSD1306_ROTATION_270
+                                                      : SSD1306_ROTATION_90)
+                                           : (flipped ? SSD1306_ROTATION_180
+                                                      : SSD1306_ROTATION_0));
+  }
+
+  /**
+   * @brief   The C handle, for the functions of ssd1306.h and friends
+   */
+  ssd1306_handle_t handle() const { return handle_; }
+  operator ssd1306_handle_t() const { return handle_; }
+
+  /**
+   * @brief   Send the framebuffer, see ssd1306_refresh_gram
+   */
+  esp_err_t refresh() { return ssd1306_refresh_gram(handle_); }
+
+  void clear(bool on = false) {
+    memset(fb_, on ? 0xFF : 0x00, SSD1306_WIDTH * SSD1306_HEIGHT / 8);
+  }
+
+  void pixel(int x, int y, bool on = true) {
+    if (x < 0 || x >= W || y < 0 || y >= H) {
+      return;
+    }
+    if (portrait) {
+      int t = x;
+      x = y;
+      y = t;
+    }
+    uint8_t *byte = &fb_[x * 8 + 7 - y / 8];
+    uint8_t bit = 0x80 >> (y % 8);
+    *byte = on ? *byte | bit : *byte & ~bit;
+  }
+
+  bool get_pixel(int x, int y) const {
+    if (x < 0 || x >= W || y < 0 || y >= H) {
+      return false;
+    }
+    if (portrait) {
+      int t = x;
+      x = y;
+      y = t;
+    }
+    return fb_[x * 8 + 7 - y / 8] & (0x80 >> (y % 8));
+  }
+
+  /**
+   * @brief   Fill the rectangle with corners (x1, y1) and (x2, y2), inclusive
+   */
+  void fill_rect(int x1, int y1, int x2, int y2, bool on = true) {
+    x1 = x1 < 0 ? 0 : x1;
+    y1 = y1 < 0 ? 0 : y1;
+    x2 = x2 >= W ? W - 1 : x2;
+    y2 = y2 >= H ? H - 1 : y2;
+    if (x1 > x2 || y1 > y2) {
+      return;
+    }
+    if (portrait) {
+      fill_panel(y1, x1, y2, x2, on);
+    } else {
+      fill_panel(x1, y1, x2, y2, on);
+    }
+  }
+
+  /**
+   * @brief   Draw a line, stepping as ssd1306_draw_line does
+   *
+   * Points off the display are skipped rather than wrapped around.
+   */
+  void line(int x1, int y1, int x2, int y2, bool on = true) {
+    int x_len = x1 > x2 ? x1 - x2 : x2 - x1;
+    int y_len = y1 > y2 ? y1 - y2 : y2 - y1;
+    bool steep = y_len >= x_len;
+
+    // walk along the longer axis, from its lower end
+    if (steep ? y1 > y2 : x1 > x2) {
+      int t = x1;
+      x1 = x2;
+      x2 = t;
+      t = y1;
+      y1 = y2;
+      y2 = t;
+    }
+    int len = steep ? y_len : x_len, step = steep ? x_len : y_len;
+    int &major = steep ? y1 : x1, &minor = steep ? x1 : y1;
+    int minor_end = steep ? x2 : y2;
+    int diff = step;
+
+    for (int i = 0; i <= len; i++) {
+      if (diff >= len) {
+        diff -= len;
+        minor += minor < minor_end ? 1 : -1;
+      }
+      diff += step;
+      pixel(x1, y1, on);
+      major++;
+    }
+  }
+
+  /**
+   * @brief   Print text with a generated font
+   *
+   * Glyphs are placed, and their background cleared, exactly as
+   * ssd1306_draw_bdf_text does with the BDF font they were generated from.
+   *
+   * @return  X position after the text
+   */
+  int text(int x, int y, const Font &font, const char *string) {
+    for (; *string; string++) {
+      uint8_t code = static_cast<uint8_t>(*string);
+      if (code == '\n') {
+        x = 0;
+        y += font.height;
+      }
+      const Glyph *g = font.glyph(code);
+      if (!g) {
+        continue;
+      }
+      int stride = (g->width + 7) / 8;
+      int left = x + g->x_offset;
+      int top = y + (font.height - g->height) + font.y_offset - g->y_offset;
+      const uint8_t *row = font.bitmaps + g->bitmap;
+      for (int gy = 0; gy < g->height; gy++, row += stride) {
+        for (int gx = 0; gx < stride * 8; gx++) {
+          pixel(left + gx, top + gy, row[gx / 8] & (0x80 >> (gx % 8)));
+        }
+      }
+      x += g->advance;
+    }
+    return x;
+  }
+
+private:
+  // Panel coordinates, already clipped: one column word per x.
+  void fill_panel(int x1, int y1, int x2, int y2, bool on) {
+    uint64_t rows = (UINT64_MAX >> y1) & (UINT64_MAX << (63 - y2));
+    for (int x = x1; x <= x2; x++) {
+      uint64_t column;
+      memcpy(&column, &fb_[x * 8], sizeof(column));
+      column = on ? column | rows : column & ~rows;
+      memcpy(&fb_[x * 8], &column, sizeof(column));
+    }
+  }
+
+  ssd1306_handle_t handle_;
+  uint8_t *fb_;
+};
+
+} // namespace ssd1306
@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 delta-encoded animation player
+ *
+ * Animations are produced on the host by tools/ssd1306_anim.py from a
+ * sequence of 128x64 PBM frames. The stream layout is:
+ *
+ *   header     'S' 'A' version(1) fps frame_count(u16 LE) reserved(2)
+ *   frame      window_count(u8), then per window:
+ *              c0 c1 p0 p1, followed by the window's GRAM bytes (column by
+ *              column, pages p0..p1 of each) compressed as in ssd1306_rle.h
+ *
+ * Each window carries the new content of a GRAM area that changed since the
+ * previous frame; the first frame covers the whole panel. The player decodes
+ * a window into the framebuffer and sends it to the panel in the same pass,
+ * reading through a small fixed buffer, so a frame costs only the bytes that
+ * changed.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+#include <stddef.h>
+#include <stdio.h>
+
+typedef void *ssd1306_anim_handle_t; /*handle of an animation player*/
+
+/**
+ * @brief   Open an animation held in memory, e.g. a const array in flash
+ *
+ * @param   dev object handle of ssd1306
+ * @param   buffer animation stream
+ * @param   length length of the stream in bytes
+ *
+ * @return
+ *     - player handle, or NULL on a bad header or out of memory
+ */
+ssd1306_anim_handle_t ssd1306_anim_open_buffer(ssd1306_handle_t dev,
+                                               const void *buffer,
+                                               size_t length);
+
+/**
+ * @brief   Open an animation from a file, starting at its current position
+ *
+ * The file stays owned by the caller and must remain open until
+ * ssd1306_anim_close.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   file animation file
+ *
+ * @return
+ *     - player handle, or NULL on a bad header or out of memory
+ */
+ssd1306_anim_handle_t ssd1306_anim_open_file(ssd1306_handle_t dev, FILE *file);
+
+/**
+ * @brief   Close a player
+ *
+ * @param   anim player handle
+ */
+void ssd1306_anim_close(ssd1306_anim_handle_t anim);
+
+/**
+ * @brief   Frame rate the animation was encoded for
+ *
+ * @param   anim player handle
+ */
+uint8_t ssd1306_anim_get_fps(ssd1306_anim_handle_t anim);
+
+/**
+ * @brief   Decode the next frame into the framebuffer and send its changes
+ *
+ * The device lock is held for the whole frame, so drawing from other tasks
+ * lands before or after it, never in the middle. Windows are sent with the
+ * retries and recovery of ssd1306_set_bus_config; if the panel was
+ * re-initialised during the frame, the whole framebuffer is sent after it.
+ *
+ * On an error the player goes back to the start of the frame, so the next
+ * call decodes and sends the same frame again.
+ *
+ * @param   anim player handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NOT_FOUND No frames left
+ *     - ESP_ERR_INVALID_SIZE Stream is truncated or malformed
+ *     - others Bus error, as i2c_master_transmit
+ */
+esp_err_t ssd1306_anim_next_frame(ssd1306_anim_handle_t anim);
+
+/**
+ * @brief   Go back to the first frame
+ *
+ * @param   anim player handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL File could not be repositioned
+ */
+esp_err_t ssd1306_anim_rewind(ssd1306_anim_handle_t anim);
+
+/**
+ * @brief   Play the animation at its frame rate, blocking until done
+ *
+ * @param   anim player handle
+ * @param   count how many times to play it
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - others as ssd1306_anim_next_frame and ssd1306_anim_rewind
+ */
+esp_err_t ssd1306_anim_play(ssd1306_anim_handle_t anim, uint16_t count);
+
+#ifdef __cplusplus
+}
+#endif
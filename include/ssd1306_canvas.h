@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 offscreen canvases
+ *
+ * A canvas is an offscreen 1bpp image in the framebuffer's page-packed
+ * column layout. A canvas handle can be passed to every drawing function
+ * in ssd1306.h (points, lines, rectangles, bitmaps, BDF text, region and
+ * batched operations, ssd1306_clear_screen) and to ssd1306_draw_rle_bitmap,
+ * so static widgets can be rendered once and then blitted onto the display
+ * each frame at a few word operations per column.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+
+typedef void *ssd1306_canvas_handle_t; /*handle of an offscreen canvas*/
+
+/**
+ * @brief  Bytes of pixel storage a canvas of the given width needs
+ */
+#define SSD1306_CANVAS_BUFFER_SIZE(width) ((width) * 8)
+
+/**
+ * @brief   Create a blank canvas
+ *
+ * @param   chWidth canvas width
+ * @param   chHeight canvas height, at most SSD1306_HEIGHT
+ *
+ * @return
+ *     - canvas handle, or NULL on invalid size or out of memory
+ */
+ssd1306_canvas_handle_t ssd1306_canvas_create(uint8_t chWidth,
+                                              uint8_t chHeight);
+
+/**
+ * @brief   Create a canvas drawing into caller-owned pixel storage
+ *
+ * Lets canvases live in static memory or an application pool. The storage
+ * is used as is, not cleared.
+ *
+ * @param   pchBuffer SSD1306_CANVAS_BUFFER_SIZE(chWidth) bytes, kept until
+ *          the canvas is deleted
+ * @param   chWidth canvas width
+ * @param   chHeight canvas height, at most SSD1306_HEIGHT
+ *
+ * @return
+ *     - canvas handle, or NULL on invalid size or out of memory
+ */
+ssd1306_canvas_handle_t ssd1306_canvas_create_with_buffer(uint8_t *pchBuffer,
+                                                          uint8_t chWidth,
+                                                          uint8_t chHeight);
+
+/**
+ * @brief   Release a canvas
+ *
+ * Caller-owned pixel storage is left alone.
+ *
+ * @param   canvas canvas handle
+ */
+void ssd1306_canvas_delete(ssd1306_canvas_handle_t canvas);
+
+/**
+ * @brief   Use the BDF font loaded into another display or canvas
+ *
+ * The font is shared, not copied.
+ *
+ * @param   canvas canvas handle
+ * @param   src display or canvas handle with a loaded font
+ */
+void ssd1306_canvas_set_font(ssd1306_canvas_handle_t canvas,
+                             ssd1306_handle_t src);
+
+/**
+ * @brief   Copy a canvas onto the display or another canvas at (x, y)
+ *
+ * Every canvas pixel replaces the one below it. The position may be partly
+ * off screen.
+ *
+ * @param   dst display or canvas handle, not src
+ * @param   x destination X position
+ * @param   y destination Y position
+ * @param   src canvas handle
+ */
+void ssd1306_blit(ssd1306_handle_t dst, int16_t x, int16_t y,
+                  ssd1306_canvas_handle_t src);
+
+/**
+ * @brief   Copy part of a canvas onto the display or another canvas
+ *
+ * @param   dst display or canvas handle, not src
+ * @param   x destination X position
+ * @param   y destination Y position
+ * @param   src canvas handle
+ * @param   chSrcX source rectangle X position
+ * @param   chSrcY source rectangle Y position
+ * @param   chWidth source rectangle width
+ * @param   chHeight source rectangle height
+ */
+void ssd1306_blit_region(ssd1306_handle_t dst, int16_t x, int16_t y,
+                         ssd1306_canvas_handle_t src, uint8_t chSrcX,
+                         uint8_t chSrcY, uint8_t chWidth, uint8_t chHeight);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 concurrent drawing
+ *
+ * In concurrent mode any number of tasks, on either core, post drawing
+ * commands into a lock-free queue and a render task owned by the driver
+ * applies them to the framebuffer and refreshes the panel. Producers never
+ * wait for each other or for the bus.
+ *
+ * Code that still draws directly wraps its drawing in ssd1306_lock /
+ * ssd1306_unlock. The render task holds the same lock while it applies a
+ * batch, and a refresh takes it just long enough to copy the framebuffer,
+ * so the panel never shows a half-drawn frame. The transfer is sent from
+ * that copy with the lock released, and drawing carries on meanwhile. The
+ * BDF text renderer keeps global state, so direct BDF text drawing must
+ * also happen under the lock.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "ssd1306.h"
+
+#define SSD1306_CMD_TEXT_LEN 24 /*!< longest text a command carries, + NUL */
+
+/**
+ * @brief  Drawing command kinds
+ */
+typedef enum {
+  SSD1306_CMD_FILL_POINT = 0, /*!< ssd1306_fill_point */
+  SSD1306_CMD_FILL_RECTANGLE, /*!< ssd1306_fill_rectangle */
+  SSD1306_CMD_DRAW_LINE,      /*!< ssd1306_draw_line */
+  SSD1306_CMD_DRAW_BITMAP,    /*!< ssd1306_draw_bitmap */
+  SSD1306_CMD_DRAW_TEXT,      /*!< ssd1306_draw_bdf_text */
+  SSD1306_CMD_CLEAR,          /*!< ssd1306_clear_screen */
+  SSD1306_CMD_REFRESH,        /*!< send the frame drawn so far */
+  SSD1306_CMD_BLIT,           /*!< ssd1306_blit */
+} ssd1306_cmd_type_t;
+
+/**
+ * @brief  A drawing command, copied into the queue when posted
+ */
+typedef struct {
+  ssd1306_cmd_type_t type;
+  union {
+    struct {
+      uint8_t x, y, on;
+    } point;
+    struct {
+      uint8_t x1, y1, x2, y2, on;
+    } rect;
+    struct {
+      int16_t x1, y1, x2, y2;
+    } line;
+    struct {
+      uint8_t x, y, width, height;
+      const uint8_t *data; /*!< not copied: must stay valid until drawn */
+    } bitmap;
+    struct {
+      uint8_t x, y;
+      char text[SSD1306_CMD_TEXT_LEN]; /*!< truncated if longer */
+    } text;
+    struct {
+      uint8_t fill;
+    } clear;
+    struct {
+      int16_t x, y;
+      const void *canvas; /*!< not copied: must stay valid until drawn */
+    } blit;
+  };
+} ssd1306_cmd_t;
+
+/**
+ * @brief  Concurrent mode settings
+ */
+typedef struct {
+  uint16_t queue_len;        /*!< command slots, rounded up to a power of 2 */
+  uint32_t task_stack;       /*!< render task stack size */
+  UBaseType_t task_priority; /*!< render task priority */
+  BaseType_t task_core;      /*!< render task core, or tskNO_AFFINITY */
+  bool auto_refresh;         /*!< refresh after every batch of commands, not
+                                  only on SSD1306_CMD_REFRESH */
+} ssd1306_concurrent_config_t;
+
+#define SSD1306_CONCURRENT_CONFIG_DEFAULT()                                    \
+  {                                                                            \
+    .queue_len = 64, .task_stack = 4096, .task_priority = 5,                   \
+    .task_core = tskNO_AFFINITY, .auto_refresh = false,                        \
+  }
+
+/**
+ * @brief   Enter concurrent mode
+ *
+ * Creates the device lock (with a 1 KB framebuffer copy for refreshes),
+ * the command queue and the render task. When the
+ * paced refresh task is running, SSD1306_CMD_REFRESH and auto refresh go
+ * through ssd1306_request_refresh instead of refreshing directly.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   config settings
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG queue_len is zero
+ *     - ESP_ERR_INVALID_STATE Already in concurrent mode
+ *     - ESP_ERR_NO_MEM Out of memory
+ */
+esp_err_t ssd1306_concurrent_start(ssd1306_handle_t dev,
+                                   const ssd1306_concurrent_config_t *config);
+
+/**
+ * @brief   Leave concurrent mode
+ *
+ * Posting is closed first and calls to ssd1306_post_command already in
+ * progress are waited for; every command they queued is applied before the
+ * render task exits. The device lock stays available.
+ *
+ * @param   dev object handle of ssd1306
+ */
+void ssd1306_concurrent_stop(ssd1306_handle_t dev);
+
+/**
+ * @brief   Queue a drawing command
+ *
+ * Lock-free and safe to call from any task on any core.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   cmd command, copied into the queue
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE Not in concurrent mode, or stopping
+ *     - ESP_ERR_NO_MEM Queue is full, the command was dropped
+ */
+esp_err_t ssd1306_post_command(ssd1306_handle_t dev, const ssd1306_cmd_t *cmd);
+
+/**
+ * @brief   Take the device lock for direct framebuffer access
+ *
+ * Recursive. Does nothing until ssd1306_concurrent_start has created the
+ * lock.
+ *
+ * @param   dev object handle of ssd1306
+ */
+void ssd1306_lock(ssd1306_handle_t dev);
+
+/**
+ * @brief   Release the device lock
+ *
+ * @param   dev object handle of ssd1306
+ */
+void ssd1306_unlock(ssd1306_handle_t dev);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 display lists
+ *
+ * A display list records drawing commands (the ssd1306_cmd_t of concurrent
+ * mode) instead of drawing them. Executing it draws the commands in order,
+ * except those whose pixels would all be overwritten anyway: a command whose
+ * area is covered by a later rectangle fill, blit or clear, or that lies
+ * outside the clip, is skipped. A list can be executed any number of times,
+ * onto the display or a canvas, to replay a frame without re-running the
+ * code that built it.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+#include "ssd1306_concurrent.h"
+
+typedef void *ssd1306_dlist_handle_t; /*handle of a display list*/
+
+/**
+ * @brief  Counters of the last ssd1306_dlist_execute
+ */
+typedef struct {
+  uint16_t commands; /*!< commands in the list */
+  uint16_t occluded; /*!< skipped, covered by a later opaque command */
+  uint16_t clipped;  /*!< skipped, outside the clip */
+} ssd1306_dlist_stats_t;
+
+/**
+ * @brief   Create an empty display list
+ *
+ * @param   capacity most commands the list can hold
+ *
+ * @return
+ *     - display list handle, or NULL if capacity is 0 or out of memory
+ */
+ssd1306_dlist_handle_t ssd1306_dlist_create(uint16_t capacity);
+
+/**
+ * @brief   Release a display list
+ *
+ * @param   dlist display list handle
+ */
+void ssd1306_dlist_delete(ssd1306_dlist_handle_t dlist);
+
+/**
+ * @brief   Remove all commands, to record the next frame
+ *
+ * @param   dlist display list handle
+ */
+void ssd1306_dlist_reset(ssd1306_dlist_handle_t dlist);
+
+/**
+ * @brief   Append a drawing command
+ *
+ * The command is copied; bitmap data and canvases are referenced and must
+ * stay valid while the list is executed. SSD1306_CMD_REFRESH is ignored
+ * when executing: refresh after ssd1306_dlist_execute.
+ *
+ * @param   dlist display list handle
+ * @param   cmd command to record
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_NO_MEM The list is full
+ */
+esp_err_t ssd1306_dlist_add(ssd1306_dlist_handle_t dlist,
+                            const ssd1306_cmd_t *cmd);
+
+/**
+ * @brief   Draw the recorded commands
+ *
+ * Occlusion is worked out on the first execution after the list changed and
+ * reused by later ones. It does not depend on the target, whose clip is
+ * checked on every execution. Clears ignore the clip and are always drawn.
+ *
+ * @param   dev display or canvas handle to draw on
+ * @param   dlist display list handle
+ */
+void ssd1306_dlist_execute(ssd1306_handle_t dev, ssd1306_dlist_handle_t dlist);
+
+/**
+ * @brief   Read the counters of the last execution
+ *
+ * @param   dlist display list handle
+ * @param   stats filled with the counters
+ */
+void ssd1306_dlist_get_stats(ssd1306_dlist_handle_t dlist,
+                             ssd1306_dlist_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,180 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 frame-rate-modulated grayscale
+ *
+ * A gray image is held as bitplanes in the framebuffer layout: plane k holds
+ * bit k of every pixel's level. A driver task shows plane k for 2^k time
+ * slots in turn, so level L of 2^planes - 1 looks L / (2^planes - 1) bright.
+ * Each plane is sent as a DIFF refresh against the one shown before it, so
+ * only columns that differ between planes go over the bus.
+ *
+ * Flicker-free results need a short slot, and so CONFIG_FREERTOS_HZ=1000
+ * and a bus fast enough to send the differing columns within one slot;
+ * ssd1306_gray_get_stats reports slots the driver could not keep.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "ssd1306.h"
+
+#define SSD1306_GRAY_MAX_PLANES 4
+
+/**
+ * @brief  Grayscale mode settings
+ */
+typedef struct {
+  uint8_t planes;            /*!< bitplanes, 2 to SSD1306_GRAY_MAX_PLANES */
+  uint8_t slot_ms;           /*!< time the least significant plane is shown */
+  uint32_t task_stack;       /*!< driver task stack size, in bytes */
+  UBaseType_t task_priority; /*!< driver task priority */
+  BaseType_t task_core;      /*!< driver task core, or tskNO_AFFINITY */
+} ssd1306_gray_config_t;
+
+#define SSD1306_GRAY_CONFIG_DEFAULT()                                          \
+  {                                                                            \
+    .planes = 2, .slot_ms = 4, .task_stack = 4096, .task_priority = 10,        \
+    .task_core = tskNO_AFFINITY,                                               \
+  }
+
+/**
+ * @brief  Counters kept by the grayscale driver task
+ */
+typedef struct {
+  uint32_t cycles;           /*!< complete passes over all planes */
+  uint32_t slots_missed;     /*!< planes shown late, after a slow transfer */
+  uint32_t transfers_failed; /*!< plane refreshes that failed */
+} ssd1306_gray_stats_t;
+
+/**
+ * @brief   Enter grayscale mode
+ *
+ * Allocates the planes (cleared to level 0), creates the device lock,
+ * switches to SSD1306_REFRESH_DIFF and starts the driver task; on failure
+ * the refresh mode is left as it was. While it runs, the task owns the
+ * framebuffer and the refreshes: draw with the functions below, or into
+ * ssd1306_gray_plane, not into the display.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   config settings, see SSD1306_GRAY_CONFIG_DEFAULT
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Unsupported plane count or zero slot time
+ *     - ESP_ERR_INVALID_STATE Grayscale mode is already running
+ *     - ESP_ERR_NO_MEM Out of memory
+ */
+esp_err_t ssd1306_gray_start(ssd1306_handle_t dev,
+                             const ssd1306_gray_config_t *config);
+
+/**
+ * @brief   Leave grayscale mode
+ *
+ * The driver task exits, the planes are freed and the refresh mode in use
+ * before ssd1306_gray_start is restored. The framebuffer keeps the plane
+ * shown last.
+ *
+ * @param   dev object handle of ssd1306
+ */
+void ssd1306_gray_stop(ssd1306_handle_t dev);
+
+/**
+ * @brief   Get a bitplane as a drawing target
+ *
+ * The returned handle is accepted by every drawing function in ssd1306.h,
+ * for 1bpp drawing into a single plane. It follows the display's rotation
+ * and clip as of this call.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chPlane plane index, 0 is the least significant
+ *
+ * @return
+ *     - plane handle, or NULL if grayscale mode is not running or chPlane is
+ *       out of range
+ */
+ssd1306_handle_t ssd1306_gray_plane(ssd1306_handle_t dev, uint8_t chPlane);
+
+/**
+ * @brief   Fill every plane with a gray level
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chLevel gray level
+ */
+void ssd1306_gray_clear(ssd1306_handle_t dev, uint8_t chLevel);
+
+/**
+ * @brief   Set the gray level of (x, y)
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos Specifies the X position
+ * @param   chYpos Specifies the Y position
+ * @param   chLevel gray level, 0 (off) to 2^planes - 1 (fully on)
+ */
+void ssd1306_gray_fill_point(ssd1306_handle_t dev, uint8_t chXpos,
+                             uint8_t chYpos, uint8_t chLevel);
+
+/**
+ * @brief   Fill a rectangle with a gray level
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1 Specifies the X position 1 (X top left position)
+ * @param   chYpos1 Specifies the Y position 1 (Y top left position)
+ * @param   chXpos2 Specifies the X position 2 (X bottom right position)
+ * @param   chYpos2 Specifies the Y position 2 (Y bottom right position)
+ * @param   chLevel gray level
+ */
+void ssd1306_gray_fill_rectangle(ssd1306_handle_t dev, uint8_t chXpos1,
+                                 uint8_t chYpos1, uint8_t chXpos2,
+                                 uint8_t chYpos2, uint8_t chLevel);
+
+/**
+ * @brief   Draw a line in a gray level
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos1 Specifies the X position of the starting point of the line
+ * @param   chYpos1 Specifies the Y position of the starting point of the line
+ * @param   chXpos2 Specifies the X position of the ending point of the line
+ * @param   chYpos2 Specifies the Y position of the ending point of the line
+ * @param   chLevel gray level
+ */
+void ssd1306_gray_draw_line(ssd1306_handle_t dev, int16_t chXpos1,
+                            int16_t chYpos1, int16_t chXpos2, int16_t chYpos2,
+                            uint8_t chLevel);
+
+/**
+ * @brief   Draw text with the display's BDF font in a gray level
+ *
+ * Glyph background pixels are set to level 0, as ssd1306_draw_bdf_text
+ * clears them.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos Specifies the X position
+ * @param   chYpos Specifies the Y position
+ * @param   string text to print
+ * @param   chLevel gray level
+ */
+void ssd1306_gray_draw_bdf_text(ssd1306_handle_t dev, uint8_t chXpos,
+                                uint8_t chYpos, const char *string,
+                                uint8_t chLevel);
+
+/**
+ * @brief   Read the grayscale driver counters
+ *
+ * @param   dev object handle of ssd1306
+ * @param   stats filled with the counters since ssd1306_gray_start
+ */
+void ssd1306_gray_get_stats(ssd1306_handle_t dev, ssd1306_gray_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
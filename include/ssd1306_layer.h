@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 layer compositor
+ *
+ * Layers are offscreen 1bpp images stacked over the display in creation
+ * order (the first layer created is the bottom one). ssd1306_compose writes
+ * the blended result into the framebuffer, recompositing only the columns
+ * covered by layers that moved or changed since the last call. Columns the
+ * compositor touches are fully owned by it, so draw static backgrounds into
+ * the bottom layer rather than straight into the framebuffer.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+
+typedef void *ssd1306_layer_handle_t; /*handle of a compositor layer*/
+
+/**
+ * @brief  How a layer is combined with the layers below it
+ */
+typedef enum {
+  SSD1306_BLEND_REPLACE = 0, /*!< layer pixels replace what is below */
+  SSD1306_BLEND_OR,          /*!< set pixels are drawn, clear ones see-through */
+  SSD1306_BLEND_AND,         /*!< clear pixels erase what is below */
+  SSD1306_BLEND_XOR,         /*!< set pixels invert what is below */
+} ssd1306_blend_t;
+
+/**
+ * @brief   Create a layer on top of the existing ones
+ *
+ * The layer starts hidden at (0, 0), blank, with SSD1306_BLEND_REPLACE.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chWidth layer width
+ * @param   chHeight layer height, at most SSD1306_HEIGHT
+ * @param   masked whether the layer has a mask restricting where it applies;
+ *          unmasked layers apply over their whole area
+ *
+ * @return
+ *     - layer handle, or NULL on invalid size or out of memory
+ */
+ssd1306_layer_handle_t ssd1306_layer_create(ssd1306_handle_t dev,
+                                            uint8_t chWidth, uint8_t chHeight,
+                                            bool masked);
+
+/**
+ * @brief   Remove a layer from the stack and release it
+ *
+ * @param   layer layer handle
+ */
+void ssd1306_layer_delete(ssd1306_layer_handle_t layer);
+
+/**
+ * @brief   Move a layer so its top-left corner is at (x, y) on the display
+ *
+ * @param   layer layer handle
+ * @param   x X position, may be negative or past the display edge
+ * @param   y Y position, may be negative or past the display edge
+ */
+void ssd1306_layer_set_position(ssd1306_layer_handle_t layer, int16_t x,
+                                int16_t y);
+
+/**
+ * @brief   Show or hide a layer
+ *
+ * @param   layer layer handle
+ * @param   visible whether the layer is composited
+ */
+void ssd1306_layer_set_visible(ssd1306_layer_handle_t layer, bool visible);
+
+/**
+ * @brief   Set the blend operation of a layer
+ *
+ * @param   layer layer handle
+ * @param   blend blend operation
+ */
+void ssd1306_layer_set_blend(ssd1306_layer_handle_t layer,
+                             ssd1306_blend_t blend);
+
+/**
+ * @brief   Fill a whole layer, and reset its mask to opaque
+ *
+ * @param   layer layer handle
+ * @param   chFill 0 to clear the layer, any other value to set it
+ */
+void ssd1306_layer_clear(ssd1306_layer_handle_t layer, uint8_t chFill);
+
+/**
+ * @brief   Draw point on (x, y) in layer coordinates
+ *
+ * @param   layer layer handle
+ * @param   chXpos Specifies the X position
+ * @param   chYpos Specifies the Y position
+ * @param   chPoint fill point
+ */
+void ssd1306_layer_fill_point(ssd1306_layer_handle_t layer, uint8_t chXpos,
+                              uint8_t chYpos, uint8_t chPoint);
+
+/**
+ * @brief   Copy a bitmap into a layer at (x, y) in layer coordinates
+ *
+ * Unlike ssd1306_draw_bitmap, clear bitmap pixels clear the layer.
+ *
+ * @param   layer layer handle
+ * @param   chXpos Specifies the X position
+ * @param   chYpos Specifies the Y position
+ * @param   pchBmp row-major 1bpp bitmap, as for ssd1306_draw_bitmap
+ * @param   chWidth picture width
+ * @param   chHeight picture height
+ */
+void ssd1306_layer_draw_bitmap(ssd1306_layer_handle_t layer, uint8_t chXpos,
+                               uint8_t chYpos, const uint8_t *pchBmp,
+                               uint8_t chWidth, uint8_t chHeight);
+
+/**
+ * @brief   Copy a bitmap into the mask of a masked layer
+ *
+ * Set mask pixels are where the layer applies; clear ones let the layers
+ * below show through regardless of the blend operation.
+ *
+ * @param   layer layer handle
+ * @param   chXpos Specifies the X position
+ * @param   chYpos Specifies the Y position
+ * @param   pchMask row-major 1bpp bitmap, as for ssd1306_draw_bitmap
+ * @param   chWidth picture width
+ * @param   chHeight picture height
+ */
+void ssd1306_layer_draw_mask(ssd1306_layer_handle_t layer, uint8_t chXpos,
+                             uint8_t chYpos, const uint8_t *pchMask,
+                             uint8_t chWidth, uint8_t chHeight);
+
+/**
+ * @brief   Mark a layer for recompositing after changing it behind the
+ *          compositor's back
+ *
+ * @param   layer layer handle
+ */
+void ssd1306_layer_invalidate(ssd1306_layer_handle_t layer);
+
+/**
+ * @brief   Recomposite the columns affected by layer changes into the
+ *          framebuffer
+ *
+ * The pages that changed are marked as ssd1306_mark_dirty does, for
+ * ssd1306_refresh_dirty.
+ *
+ * @param   dev object handle of ssd1306
+ */
+void ssd1306_compose(ssd1306_handle_t dev);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,146 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 mirror stream
+ *
+ * Exports what the panel shows, for remote monitoring. After every refresh
+ * the driver compares the framebuffer with the last mirrored frame and
+ * encodes the changed GRAM areas as one frame of the ssd1306_anim.h stream
+ * format: window_count, then per window c0 c1 p0 p1 and the window's bytes
+ * compressed as in ssd1306_rle.h. A frame costs bytes in proportion to what
+ * changed.
+ *
+ * Frames are queued in a ring buffer without waiting and handed to the
+ * callback by a separate task, so a slow consumer never holds up a refresh.
+ * A frame that does not fit in the ring buffer is dropped and the next one
+ * is a keyframe (a single window covering the whole panel), so a receiver
+ * that applies every frame it gets is back in sync after a drop.
+ * tools/ssd1306_mirror.py rebuilds the frames on the host.
+ *
+ * In grayscale mode only the top plane is mirrored, once per cycle: the
+ * pixels at half brightness and up.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "ssd1306.h"
+#include <stddef.h>
+
+/**
+ * @brief  Largest encoded frame: a window per column, all incompressible
+ */
+#define SSD1306_MIRROR_FRAME_MAX                                               \
+  (1 + SSD1306_WIDTH * 5 + SSD1306_WIDTH * SSD1306_HEIGHT / 8 * 129 / 128)
+
+/**
+ * @brief  Smallest ring buffer: a no-split ring buffer takes items of up to
+ *         half its size, each with an 8-byte header
+ */
+#define SSD1306_MIRROR_BUFFER_MIN (2 * (SSD1306_MIRROR_FRAME_MAX + 8))
+
+/**
+ * @brief  Called from the mirror task with each frame
+ *
+ * @param  frame encoded frame, valid until the callback returns
+ * @param  len length of the frame in bytes
+ * @param  ctx ctx from the configuration
+ */
+typedef void (*ssd1306_mirror_cb_t)(const uint8_t *frame, size_t len,
+                                    void *ctx);
+
+/**
+ * @brief  Mirror stream settings
+ */
+typedef struct {
+  ssd1306_mirror_cb_t callback; /*!< receives the frames */
+  void *ctx;                    /*!< passed to the callback */
+  size_t buffer_size; /*!< ring buffer bytes, SSD1306_MIRROR_BUFFER_MIN
+                           or more */
+  uint32_t task_stack;       /*!< mirror task stack size, in bytes */
+  UBaseType_t task_priority; /*!< mirror task priority */
+  BaseType_t task_core;      /*!< mirror task core, or tskNO_AFFINITY */
+} ssd1306_mirror_config_t;
+
+#define SSD1306_MIRROR_CONFIG_DEFAULT()                                        \
+  {                                                                            \
+    .callback = NULL, .ctx = NULL, .buffer_size = 4096, .task_stack = 4096,    \
+    .task_priority = 2, .task_core = tskNO_AFFINITY,                           \
+  }
+
+/**
+ * @brief  Counters kept by the mirror stream
+ */
+typedef struct {
+  uint32_t frames;    /*!< frames queued */
+  uint32_t keyframes; /*!< of which keyframes */
+  uint32_t dropped;   /*!< frames lost to a full ring buffer */
+  uint32_t bytes;     /*!< encoded bytes queued */
+} ssd1306_mirror_stats_t;
+
+/**
+ * @brief   Start mirroring the display
+ *
+ * Allocates the ring buffer and starts the mirror task. The first frame,
+ * queued by the next refresh, is a keyframe.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   config settings, see SSD1306_MIRROR_CONFIG_DEFAULT
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG No callback, or the ring buffer is too small
+ *     - ESP_ERR_INVALID_STATE The mirror is already running
+ *     - ESP_ERR_NO_MEM Out of memory
+ */
+esp_err_t ssd1306_mirror_start(ssd1306_handle_t dev,
+                               const ssd1306_mirror_config_t *config);
+
+/**
+ * @brief   Stop mirroring; frames still queued are discarded
+ *
+ * Does nothing if the mirror is not running. Must not be called from the
+ * callback.
+ *
+ * @param   dev object handle of ssd1306
+ */
+void ssd1306_mirror_stop(ssd1306_handle_t dev);
+
+/**
+ * @brief   Queue a keyframe of the last mirrored frame now, e.g. when a
+ *          console connects, without waiting for the next refresh
+ *
+ * Before the first refresh there is nothing to send yet, and the first
+ * frame will be a keyframe anyway.
+ *
+ * @param   dev object handle of ssd1306
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_STATE The mirror is not running
+ *     - ESP_ERR_NO_MEM The ring buffer is full; the next frame will be a
+ *       keyframe
+ */
+esp_err_t ssd1306_mirror_send_keyframe(ssd1306_handle_t dev);
+
+/**
+ * @brief   Read the mirror counters; all zero if the mirror is not running
+ *
+ * @param   dev object handle of ssd1306
+ * @param   stats filled with the counters
+ */
+void ssd1306_mirror_get_stats(ssd1306_handle_t dev,
+                              ssd1306_mirror_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 numeric readout
+ *
+ * A fixed-width field of character cells for values that change often. The
+ * glyphs it can show ("0123456789+-.: ") are rasterized once from the
+ * display's BDF font; an update compares the new text with what is shown
+ * cell by cell, blits only the cells that changed and marks just those as
+ * dirty, so ssd1306_refresh_dirty sends a few bytes per changed digit.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+
+#define SSD1306_NUMERIC_MAX_CELLS 16
+
+typedef void *ssd1306_numeric_handle_t; /*handle of a numeric readout*/
+
+/**
+ * @brief   Create a numeric readout with the display's current BDF font
+ *
+ * Every cell is as wide as the widest glyph, so digits never shift. The
+ * field starts blank and is drawn on the first update.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos Specifies the X position of the field
+ * @param   chYpos Specifies the Y position of the field
+ * @param   chCells number of character cells, at most SSD1306_NUMERIC_MAX_CELLS
+ *
+ * @return
+ *     - readout handle, or NULL if no font is loaded, chCells is out of
+ *       range, the field does not fit on the display or out of memory
+ */
+ssd1306_numeric_handle_t ssd1306_numeric_create(ssd1306_handle_t dev,
+                                                uint8_t chXpos, uint8_t chYpos,
+                                                uint8_t chCells);
+
+/**
+ * @brief   Release a numeric readout
+ *
+ * What it drew stays in the framebuffer.
+ *
+ * @param   numeric readout handle
+ */
+void ssd1306_numeric_delete(ssd1306_numeric_handle_t numeric);
+
+/**
+ * @brief   Show a string, right-aligned in the field
+ *
+ * Characters without a cached glyph are shown blank.
+ *
+ * @param   numeric readout handle
+ * @param   text text to show
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_SIZE text is longer than the field, nothing changed
+ */
+esp_err_t ssd1306_numeric_set_text(ssd1306_numeric_handle_t numeric,
+                                   const char *text);
+
+/**
+ * @brief   Show a value with a fixed number of decimals
+ *
+ * ssd1306_numeric_set_fixed(numeric, 1234, 2) shows "12.34".
+ *
+ * @param   numeric readout handle
+ * @param   value value in units of 10^-decimals
+ * @param   decimals digits after the decimal point
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_SIZE value does not fit the field, nothing changed
+ */
+esp_err_t ssd1306_numeric_set_fixed(ssd1306_numeric_handle_t numeric,
+                                    int32_t value, uint8_t decimals);
+
+/**
+ * @brief   Show an integer
+ *
+ * @param   numeric readout handle
+ * @param   value value
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_SIZE value does not fit the field, nothing changed
+ */
+esp_err_t ssd1306_numeric_set_int(ssd1306_numeric_handle_t numeric,
+                                  int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 run-length compressed bitmaps
+ *
+ * Compressed bitmaps are produced on the host by tools/ssd1306_rle.py from
+ * PBM images. The layout is:
+ *
+ *   byte 0     width (1..128)
+ *   byte 1     height (1..64)
+ *   byte 2..   opcodes, until width * ceil(height / 8) bytes are produced
+ *              0x00-0x7F  literal: the next (op + 1) bytes are copied
+ *              0x80-0xFF  run: the next byte is repeated (op - 0x80 + 2) times
+ *
+ * Decoded bytes are in the panel's native order: column by column, each
+ * column as ceil(height / 8) bytes from the top, with the topmost row of a
+ * byte in bit 7. Blank areas collapse into two-byte runs, and the decoder
+ * writes straight into the framebuffer without an intermediate image.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+#include <stddef.h>
+
+/**
+ * @brief   draw a compressed bitmap on (x, y)
+ *
+ * Like ssd1306_draw_bitmap, only set pixels are drawn.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   chXpos Specifies the X position
+ * @param   chYpos Specifies the Y position
+ * @param   pchRle compressed bitmap
+ * @param   len length of the compressed bitmap in bytes
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Bad width or height in the header
+ *     - ESP_ERR_INVALID_SIZE Compressed data is truncated
+ */
+esp_err_t ssd1306_draw_rle_bitmap(ssd1306_handle_t dev, uint8_t chXpos,
+                                  uint8_t chYpos, const uint8_t *pchRle,
+                                  size_t len);
+
+/**
+ * @brief   decode a full-screen compressed bitmap and show it
+ *
+ * The image is decoded once and sent as the next full frame, so no separate
+ * refresh is needed and the refresh mode and bus settings apply; it also
+ * replaces the framebuffer. Decoding is not interleaved with the transfer:
+ * once the device lock exists (see ssd1306_concurrent_start) the image is
+ * decoded into the refresh snapshot and a truncated one leaves the
+ * framebuffer untouched; without it the image is decoded straight into the
+ * framebuffer, which then keeps the columns before the truncation.
+ *
+ * @param   dev object handle of ssd1306
+ * @param   pchRle compressed bitmap of SSD1306_WIDTH x SSD1306_HEIGHT pixels
+ * @param   len length of the compressed bitmap in bytes
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG Image is not full-screen
+ *     - ESP_ERR_INVALID_SIZE Compressed data is truncated
+ *     - any error of ssd1306_refresh_gram, from the I2C driver, when the
+ *       transfer fails; the framebuffer holds the image all the same and
+ *       the whole of it is marked dirty
+ */
+esp_err_t ssd1306_refresh_rle_bitmap(ssd1306_handle_t dev,
+                                     const uint8_t *pchRle, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
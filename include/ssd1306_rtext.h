@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 rotated text
+ *
+ * Text at 0, 90, 180 or 270 degrees, for vertical axis labels and panels
+ * mounted sideways. The glyphs of the display's BDF font are rotated once,
+ * when the cache is created, into the framebuffer's column layout; drawing
+ * a character is then a blit of its cell, a shift and masked store per
+ * column, whatever the angle.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+
+typedef void *ssd1306_rtext_handle_t; /*handle of a rotated glyph cache*/
+
+/**
+ * @brief   Rotate the glyphs of the current BDF font into a cache
+ *
+ * @param   dev object handle of ssd1306, or a canvas handle, whose BDF font
+ *          is used; the font may be unloaded afterwards
+ * @param   angle clockwise text rotation: SSD1306_ROTATION_90 reads top to
+ *          bottom, SSD1306_ROTATION_270 bottom to top
+ * @param   charset characters to cache, or NULL for all of 0x20..0x7E the
+ *          font has
+ *
+ * @return
+ *     - cache handle, or NULL if no font is loaded, angle is invalid, a glyph
+ *       is too large (more than 64 pixels tall at 0 or 180 degrees, more
+ *       than 64 pixels wide at 90 or 270) or out of memory
+ */
+ssd1306_rtext_handle_t ssd1306_rtext_create(ssd1306_handle_t dev,
+                                            ssd1306_rotation_t angle,
+                                            const char *charset);
+
+/**
+ * @brief   Release a rotated glyph cache
+ *
+ * @param   rtext cache handle
+ */
+void ssd1306_rtext_delete(ssd1306_rtext_handle_t rtext);
+
+/**
+ * @brief   Draw rotated text
+ *
+ * The result is what ssd1306_draw_bdf_text would draw at (0, 0), without
+ * word wrap, rotated about (0, 0) and moved to (chXpos, chYpos): the cursor
+ * advances along the rotated baseline, and a newline goes back to the
+ * starting point and moves one line further along the rotated vertical.
+ * Characters missing from the cache are skipped. The clip applies.
+ *
+ * @param   dev object handle of ssd1306, or a canvas handle
+ * @param   rtext cache handle
+ * @param   chXpos Specifies the X position of the text origin
+ * @param   chYpos Specifies the Y position of the text origin
+ * @param   string text to draw
+ */
+void ssd1306_rtext_draw(ssd1306_handle_t dev, ssd1306_rtext_handle_t rtext,
+                        int16_t chXpos, int16_t chYpos, const char *string);
+
+/**
+ * @brief   Length of text along the baseline, in pixels
+ *
+ * @param   rtext cache handle
+ * @param   string text to measure
+ *
+ * @return
+ *     - summed advance of the longest line
+ */
+uint16_t ssd1306_rtext_measure(ssd1306_rtext_handle_t rtext,
+                               const char *string);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,210 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 retained-mode widgets
+ *
+ * Widgets (boxes, labels, icons and bars) form a tree: each has a parent,
+ * or none for top-level widgets, a position relative to its parent and a
+ * size that also clips its children. Later siblings are drawn over earlier
+ * ones. Changing a widget only records the screen rectangle it covers as
+ * damaged; ssd1306_ui_render clears and redraws just the damaged
+ * rectangles, clipped, and marks them for ssd1306_refresh_dirty.
+ *
+ * Damaged areas are cleared to black before redrawing, so the widgets own
+ * every pixel they cover.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ssd1306.h"
+
+#define SSD1306_BOX_BORDER 0x01 /*!< 1 pixel outline */
+#define SSD1306_BOX_FILL 0x02   /*!< solid */
+
+typedef void *ssd1306_widget_handle_t; /*handle of a widget*/
+
+/**
+ * @brief   Create a box
+ *
+ * @param   dev object handle of ssd1306
+ * @param   parent parent widget, or NULL for a top-level widget
+ * @param   chXpos X position relative to the parent
+ * @param   chYpos Y position relative to the parent
+ * @param   chWidth width
+ * @param   chHeight height
+ * @param   chStyle SSD1306_BOX_* flags; 0 gives an invisible container
+ *
+ * @return
+ *     - widget handle, or NULL on out of memory
+ */
+ssd1306_widget_handle_t ssd1306_box_create(ssd1306_handle_t dev,
+                                           ssd1306_widget_handle_t parent,
+                                           uint8_t chXpos, uint8_t chYpos,
+                                           uint8_t chWidth, uint8_t chHeight,
+                                           uint8_t chStyle);
+
+/**
+ * @brief   Create a text label drawn with the display's BDF font
+ *
+ * @param   dev object handle of ssd1306
+ * @param   parent parent widget, or NULL for a top-level widget
+ * @param   chXpos X position relative to the parent
+ * @param   chYpos Y position relative to the parent
+ * @param   chWidth width, text beyond it is clipped
+ * @param   chHeight height
+ * @param   text text, copied
+ *
+ * @return
+ *     - widget handle, or NULL on out of memory
+ */
+ssd1306_widget_handle_t ssd1306_label_create(ssd1306_handle_t dev,
+                                             ssd1306_widget_handle_t parent,
+                                             uint8_t chXpos, uint8_t chYpos,
+                                             uint8_t chWidth, uint8_t chHeight,
+                                             const char *text);
+
+/**
+ * @brief   Create an icon from a bitmap in ssd1306_draw_bitmap format
+ *
+ * @param   dev object handle of ssd1306
+ * @param   parent parent widget, or NULL for a top-level widget
+ * @param   chXpos X position relative to the parent
+ * @param   chYpos Y position relative to the parent
+ * @param   pchBmp bitmap, not copied: must stay valid while the icon exists
+ * @param   chWidth bitmap width
+ * @param   chHeight bitmap height
+ *
+ * @return
+ *     - widget handle, or NULL on out of memory
+ */
+ssd1306_widget_handle_t ssd1306_icon_create(ssd1306_handle_t dev,
+                                            ssd1306_widget_handle_t parent,
+                                            uint8_t chXpos, uint8_t chYpos,
+                                            const uint8_t *pchBmp,
+                                            uint8_t chWidth, uint8_t chHeight);
+
+/**
+ * @brief   Create a horizontal bar graph
+ *
+ * @param   dev object handle of ssd1306
+ * @param   parent parent widget, or NULL for a top-level widget
+ * @param   chXpos X position relative to the parent
+ * @param   chYpos Y position relative to the parent
+ * @param   chWidth width
+ * @param   chHeight height
+ * @param   chValue fill level, 0 to 100
+ *
+ * @return
+ *     - widget handle, or NULL on out of memory
+ */
+ssd1306_widget_handle_t ssd1306_bar_create(ssd1306_handle_t dev,
+                                           ssd1306_widget_handle_t parent,
+                                           uint8_t chXpos, uint8_t chYpos,
+                                           uint8_t chWidth, uint8_t chHeight,
+                                           uint8_t chValue);
+
+/**
+ * @brief   Delete a widget and all its children
+ *
+ * @param   widget widget handle
+ */
+void ssd1306_widget_delete(ssd1306_widget_handle_t widget);
+
+/**
+ * @brief   Move a widget, relative to its parent
+ *
+ * @param   widget widget handle
+ * @param   chXpos X position
+ * @param   chYpos Y position
+ */
+void ssd1306_widget_set_position(ssd1306_widget_handle_t widget,
+                                 uint8_t chXpos, uint8_t chYpos);
+
+/**
+ * @brief   Show or hide a widget and its children
+ *
+ * Widgets are created visible.
+ *
+ * @param   widget widget handle
+ * @param   visible visibility
+ */
+void ssd1306_widget_set_visible(ssd1306_widget_handle_t widget, bool visible);
+
+/**
+ * @brief   Change a box's style
+ *
+ * @param   widget box handle
+ * @param   chStyle SSD1306_BOX_* flags
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG The widget is not a box
+ */
+esp_err_t ssd1306_box_set_style(ssd1306_widget_handle_t widget,
+                                uint8_t chStyle);
+
+/**
+ * @brief   Change a label's text
+ *
+ * Setting the text it already shows damages nothing.
+ *
+ * @param   widget label handle
+ * @param   text text, copied
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG The widget is not a label
+ *     - ESP_ERR_NO_MEM Out of memory, the old text is kept
+ */
+esp_err_t ssd1306_label_set_text(ssd1306_widget_handle_t widget,
+                                 const char *text);
+
+/**
+ * @brief   Change an icon's bitmap, keeping its size
+ *
+ * @param   widget icon handle
+ * @param   pchBmp bitmap, not copied
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG The widget is not an icon
+ */
+esp_err_t ssd1306_icon_set_bitmap(ssd1306_widget_handle_t widget,
+                                  const uint8_t *pchBmp);
+
+/**
+ * @brief   Change a bar's fill level
+ *
+ * @param   widget bar handle
+ * @param   chValue fill level, 0 to 100
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_ERR_INVALID_ARG The widget is not a bar
+ */
+esp_err_t ssd1306_bar_set_value(ssd1306_widget_handle_t widget,
+                                uint8_t chValue);
+
+/**
+ * @brief   Redraw the damaged parts of the widget tree
+ *
+ * Marks what it redraws with ssd1306_mark_dirty; call ssd1306_refresh_dirty
+ * to send it. Runs under the device lock and leaves the clip as it found
+ * it.
+ *
+ * @param   dev object handle of ssd1306
+ */
+void ssd1306_ui_render(ssd1306_handle_t dev);
+
+#ifdef __cplusplus
+}
+#endif
@@ -34,9 +34,6 @@
 
 #define FIELDLEN NVBDFLIB_FIELDLEN
 
-static char stringBuf[0x1000];
-static char cmdName[64];
-
 static struct {
   void (*function)(int x, int y, int c, void *ctx);
   int areaWidth;
@@ -70,300 +67,325 @@ static size_t fixed_strlen(const char *string) {
 
 #endif
 
-BDF_FONT *bdfReadBuffer(void *dataBuffer, int length) {
-  BDF_FONT *newFont;
-  char *strPtr;
-  char *strPtr2;
-  int *intPtr = NULL;
-  int element = 0;
-  int curChar = 0;
-  int x, l;
-  int endFont = 0;
-  int curBitmapPos = 0;
-  int isBitmap = 0;
-  char hexBuf[3];
-  unsigned int hex;
-  unsigned int bitmapSize;
-  int bufPos = 0;
-  char *buffer = dataBuffer;
+// Keywords understood by bdfReadBuffer, grouped by first letter. Lines
+// starting with anything else are skipped, or read as bitmap rows between
+// BITMAP and ENDCHAR.
+enum {
+  KW_NONE,
+  KW_BBX,
+  KW_BITMAP,
+  KW_CHARS,
+  KW_DWIDTH,
+  KW_DWIDTH1,
+  KW_ENCODING,
+  KW_ENDCHAR,
+  KW_ENDFONT,
+  KW_FONT,
+  KW_FONTBOUNDINGBOX,
+  KW_SIZE,
+  KW_STARTCHAR,
+  KW_SWIDTH,
+  KW_SWIDTH1,
+  KW_VVECTOR,
+  KW_COUNT
+};
+
+static const struct {
+  const char *name;
+  int len;
+} keywords[KW_COUNT] = {
+    [KW_BBX] = {"BBX", 3},
+    [KW_BITMAP] = {"BITMAP", 6},
+    [KW_CHARS] = {"CHARS", 5},
+    [KW_DWIDTH] = {"DWIDTH", 6},
+    [KW_DWIDTH1] = {"DWIDTH1", 7},
+    [KW_ENCODING] = {"ENCODING", 8},
+    [KW_ENDCHAR] = {"ENDCHAR", 7},
+    [KW_ENDFONT] = {"ENDFONT", 7},
+    [KW_FONT] = {"FONT", 4},
+    [KW_FONTBOUNDINGBOX] = {"FONTBOUNDINGBOX", 15},
+    [KW_SIZE] = {"SIZE", 4},
+    [KW_STARTCHAR] = {"STARTCHAR", 9},
+    [KW_SWIDTH] = {"SWIDTH", 6},
+    [KW_SWIDTH1] = {"SWIDTH1", 7},
+    [KW_VVECTOR] = {"VVECTOR", 7},
+};
+
+// Hex digit values with bit 4 set, 0 for anything else.
+static const unsigned char hexDigits[256] = {
+    ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14, ['5'] = 0x15,
+    ['6'] = 0x16, ['7'] = 0x17, ['8'] = 0x18, ['9'] = 0x19, ['A'] = 0x1A, ['B'] = 0x1B,
+    ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F, ['a'] = 0x1A, ['b'] = 0x1B,
+    ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+};
+
+// Case-insensitive keyword lookup: dispatch on the first letter, then compare
+// the few keywords starting with it. Bitmap rows mostly fall through the
+// switch or fail the length check.
+static int bdfKeyword(const char *token, int len) {
+  int kw, last, i;
+  char c;
+
+  switch (token[0]) {
+  case 'B':
+  case 'b':
+    kw = KW_BBX, last = KW_BITMAP;
+    break;
+  case 'C':
+  case 'c':
+    kw = last = KW_CHARS;
+    break;
+  case 'D':
+  case 'd':
+    kw = KW_DWIDTH, last = KW_DWIDTH1;
+    break;
+  case 'E':
+  case 'e':
+    kw = KW_ENCODING, last = KW_ENDFONT;
+    break;
+  case 'F':
+  case 'f':
+    kw = KW_FONT, last = KW_FONTBOUNDINGBOX;
+    break;
+  case 'S':
+  case 's':
+    kw = KW_SIZE, last = KW_SWIDTH1;
+    break;
+  case 'V':
+  case 'v':
+    kw = last = KW_VVECTOR;
+    break;
+  default:
+    return KW_NONE;
+  }
 
-  newFont = malloc(sizeof(BDF_FONT));
+  for (; kw <= last; kw++) {
+    if (keywords[kw].len != len)
+      continue;
 
-  if (newFont == NULL)
-    return NULL;
+    for (i = 1; i < len; i++) {
+      c = token[i];
+      if (c >= 'a' && c <= 'z')
+        c -= 'a' - 'A';
+      if (c != keywords[kw].name[i])
+        break;
+    }
 
-  bzero(newFont, sizeof(BDF_FONT));
+    if (i == len)
+      return kw;
+  }
 
-  while (bufPos < length && !endFont) {
-    element = 0;
+  return KW_NONE;
+}
 
-    x = 0;
+// Next space separated token of the line at *pos, returns its length (0 at
+// the end of the line) and moves *pos past it. Lines end at a newline or
+// carriage return; anything after a carriage return is ignored.
+static int bdfToken(const char **pos, const char *end, const char **token) {
+  const char *p = *pos;
 
-    do {
-      stringBuf[x++] = buffer[bufPos];
+  while (p < end && *p == ' ')
+    p++;
 
-      if (buffer[bufPos] == '\n') {
-        bufPos++;
-        break;
-      } else
-        bufPos++;
-    } while (x < (sizeof(stringBuf) - 1) && buffer[bufPos] && bufPos < length);
+  *token = p;
 
-    stringBuf[x] = '\0';
+  while (p < end && *p != ' ' && *p != '\n' && *p != '\r')
+    p++;
 
-    // Remove newline and carriage return.
-    strPtr = stringBuf;
+  *pos = p;
 
-    while (*strPtr) {
-      if (*strPtr == '\n')
-        *strPtr = 0;
-      else if (*strPtr == '\r')
-        *strPtr = 0;
+  return p - *token;
+}
 
-      strPtr++;
-    }
+// Reads up to count integers from the rest of the line. Like sscanf("%d"),
+// a token not starting with a number leaves its field unchanged.
+static void bdfReadInts(const char *pos, const char *end, int *const *fields, int count) {
+  const char *token;
+  int len, i, n, value, negative;
 
-    strPtr2 = stringBuf;
+  for (n = 0; n < count && (len = bdfToken(&pos, end, &token)); n++) {
+    i = 0;
+    negative = 0;
 
-    while ((strPtr = strtok(strPtr2, " "))) {
-      if (element == 0) {
-        strncpy(cmdName, strPtr, 63);
-        cmdName[63] = 0;
-      }
+    if (token[0] == '-' || token[0] == '+')
+      negative = token[i++] == '-';
 
-      if (newFont->info.chars == 0) {
-        if (strcasecmp(cmdName, "FONT") == 0) {
-          if (element == 1) {
-            strncpy(newFont->info.name, strPtr, FIELDLEN - 1);
-            newFont->info.name[FIELDLEN - 1] = 0;
-          }
-        } else if (strcasecmp(cmdName, "SIZE") == 0) {
-          if (element == 1) // PointSize
-            sscanf(strPtr, "%d", &newFont->info.pointSize);
-          else if (element == 2) // Xres
-            sscanf(strPtr, "%d", &newFont->info.xRes);
-          else if (element == 3)
-            sscanf(strPtr, "%d", &newFont->info.yRes);
-        } else if (strcasecmp(cmdName, "FONTBOUNDINGBOX") == 0) {
-          switch (element) {
-          case 1: //  FBBx
-            intPtr = &newFont->info.BBox.w;
-            break;
-          case 2: // FBBy
-            intPtr = &newFont->info.BBox.h;
-            break;
-          case 3: // Xoff
-            intPtr = &newFont->info.BBox.xOff;
-            break;
-          case 4: // Yoff
-            intPtr = &newFont->info.BBox.yOff;
-            break;
-          }
+    if (i == len || token[i] < '0' || token[i] > '9')
+      continue;
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "SWIDTH") == 0) {
-          switch (element) {
-          case 1: // swx0
-            intPtr = &newFont->info.Metrics.swx0;
-            break;
-          case 2: // swy0
-            intPtr = &newFont->info.Metrics.swy0;
-            break;
-          }
+    for (value = 0; i < len && token[i] >= '0' && token[i] <= '9'; i++)
+      value = value * 10 + (token[i] - '0');
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "DWIDTH") == 0) {
-          switch (element) {
-          case 1: // dwx0
-            intPtr = &newFont->info.Metrics.dwx0;
-            break;
-          case 2: // dwy0
-            intPtr = &newFont->info.Metrics.dwy0;
-            break;
-          }
+    *fields[n] = negative ? -value : value;
+  }
+}
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "SWIDTH1") == 0) {
-          switch (element) {
-          case 1: // swx1
-            intPtr = &newFont->info.Metrics.swx1;
-            break;
-          case 2: // swy1
-            intPtr = &newFont->info.Metrics.swy1;
-            break;
-          }
+// Copies the next token of the line into a field of size bytes.
+static void bdfReadName(const char *pos, const char *end, char *field, int size) {
+  const char *token;
+  int len = bdfToken(&pos, end, &token);
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "DWIDTH1") == 0) {
-          switch (element) {
-          case 1: // dwx1
-            intPtr = &newFont->info.Metrics.dwx1;
-            break;
-          case 2: // dwy1
-            intPtr = &newFont->info.Metrics.dwy1;
-            break;
-          }
+  if (!len)
+    return;
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "VVECTOR") == 0) {
-          switch (element) {
-          case 1: // xoff
-            intPtr = &newFont->info.Metrics.vXOff;
-            break;
-          case 2: // yoff
-            intPtr = &newFont->info.Metrics.vYOff;
-            break;
-          }
+  if (len > size - 1)
+    len = size - 1;
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "CHARS") == 0) {
-          if (element == 1) {
-            sscanf(strPtr, "%d", &newFont->info.chars);
+  memcpy(field, token, len);
+  field[len] = 0;
+}
 
-            newFont->chars = malloc(newFont->info.chars * sizeof(FontChar));
-            curChar = 0;
+static void bdfReadMetrics(int kw, const char *pos, const char *end, _Metrics *m) {
+  switch (kw) {
+  case KW_SWIDTH:
+    bdfReadInts(pos, end, (int *const[]){&m->swx0, &m->swy0}, 2);
+    break;
+  case KW_DWIDTH:
+    bdfReadInts(pos, end, (int *const[]){&m->dwx0, &m->dwy0}, 2);
+    break;
+  case KW_SWIDTH1:
+    bdfReadInts(pos, end, (int *const[]){&m->swx1, &m->swy1}, 2);
+    break;
+  case KW_DWIDTH1:
+    bdfReadInts(pos, end, (int *const[]){&m->dwx1, &m->dwy1}, 2);
+    break;
+  case KW_VVECTOR:
+    bdfReadInts(pos, end, (int *const[]){&m->vXOff, &m->vYOff}, 2);
+    break;
+  }
+}
 
-            for (x = 0; x < newFont->info.chars; x++) {
-              memcpy(&newFont->chars[x].BBox, &newFont->info.BBox, sizeof(_BBox));
-              memcpy(&newFont->chars[x].Metrics, &newFont->info.Metrics, sizeof(_Metrics));
-            }
-          }
-        }
-      } else if (newFont->info.chars > 0) {
+static void bdfReadBBox(const char *pos, const char *end, _BBox *b) {
+  bdfReadInts(pos, end, (int *const[]){&b->w, &b->h, &b->xOff, &b->yOff}, 4);
+}
 
-        if (strcasecmp(cmdName, "STARTCHAR") == 0) {
-          if (element == 1) {
-            strncpy(newFont->chars[curChar].name, strPtr, 63);
-            newFont->chars[curChar].name[63] = 0;
-            isBitmap = 0;
-          }
-        } else if (strcasecmp(cmdName, "ENCODING") == 0) {
-          if (element == 1)
-            sscanf(strPtr, "%d", &newFont->chars[curChar].encoding);
-        } else if (strcasecmp(cmdName, "BBX") == 0) {
-          switch (element) {
-          case 1: //  FBBx
-            intPtr = &newFont->chars[curChar].BBox.w;
-            break;
-          case 2: // FBBy
-            intPtr = &newFont->chars[curChar].BBox.h;
-            break;
-          case 3: // Xoff
-            intPtr = &newFont->chars[curChar].BBox.xOff;
-            break;
-          case 4: // Yoff
-            intPtr = &newFont->chars[curChar].BBox.yOff;
-            break;
-          }
+// Single pass over the buffer: each line is split into tokens in place, its
+// keyword looked up once and its values decoded directly into the font.
+BDF_FONT *bdfReadBuffer(void *dataBuffer, int length) {
+  BDF_FONT *newFont;
+  FontChar *ch = NULL;
+  const char *pos = dataBuffer;
+  const char *end = pos + length;
+  const char *token;
+  int len, kw, x;
+  int curChar = 0;
+  int endFont = 0;
+  int isBitmap = 0;
+  unsigned int curBitmapPos = 0;
+  unsigned int bitmapSize = 0;
+  unsigned int hi, lo;
+  unsigned char hex = 0;
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "SWIDTH") == 0) {
-          switch (element) {
-          case 1: // swx0
-            intPtr = &newFont->chars[curChar].Metrics.swx0;
-            break;
-          case 2: // swy0
-            intPtr = &newFont->chars[curChar].Metrics.swy0;
-            break;
-          }
+  newFont = calloc(1, sizeof(BDF_FONT));
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "DWIDTH") == 0) {
-          switch (element) {
-          case 1: // dwx0
-            intPtr = &newFont->chars[curChar].Metrics.dwx0;
-            break;
-          case 2: // dwy0
-            intPtr = &newFont->chars[curChar].Metrics.dwy0;
-            break;
-          }
+  if (newFont == NULL)
+    return NULL;
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "SWIDTH1") == 0) {
-          switch (element) {
-          case 1: // swx1
-            intPtr = &newFont->chars[curChar].Metrics.swx1;
-            break;
-          case 2: // swy1
-            intPtr = &newFont->chars[curChar].Metrics.swy1;
-            break;
-          }
+  while (pos < end && !endFont) {
+    len = bdfToken(&pos, end, &token);
+    kw = len ? bdfKeyword(token, len) : KW_NONE;
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "DWIDTH1") == 0) {
-          switch (element) {
-          case 1: // dwx1
-            intPtr = &newFont->chars[curChar].Metrics.dwx1;
-            break;
-          case 2: // dwy1
-            intPtr = &newFont->chars[curChar].Metrics.dwy1;
-            break;
-          }
+    if (newFont->info.chars == 0) {
+      switch (kw) {
+      case KW_FONT:
+        bdfReadName(pos, end, newFont->info.name, FIELDLEN);
+        break;
+      case KW_SIZE:
+        bdfReadInts(pos, end,
+                    (int *const[]){&newFont->info.pointSize, &newFont->info.xRes,
+                                   &newFont->info.yRes},
+                    3);
+        break;
+      case KW_FONTBOUNDINGBOX:
+        bdfReadBBox(pos, end, &newFont->info.BBox);
+        break;
+      case KW_CHARS:
+        bdfReadInts(pos, end, (int *const[]){&newFont->info.chars}, 1);
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "VVECTOR") == 0) {
-          switch (element) {
-          case 1: // xoff
-            intPtr = &newFont->chars[curChar].Metrics.vXOff;
-            break;
-          case 2: // yoff
-            intPtr = &newFont->chars[curChar].Metrics.vYOff;
-            break;
-          }
+        if (newFont->info.chars <= 0) {
+          newFont->info.chars = 0;
+          break;
+        }
 
-          if (intPtr)
-            sscanf(strPtr, "%d", intPtr);
-        } else if (strcasecmp(cmdName, "BITMAP") == 0) {
-          x = newFont->chars[curChar].BBox.w;
-          // Pad size to byte size...
-          if (x & 7) {
-            x |= 7;
-            x++;
-          }
+        newFont->chars = calloc(newFont->info.chars, sizeof(FontChar));
+
+        if (newFont->chars == NULL) {
+          free(newFont);
+          return NULL;
+        }
+
+        for (x = 0; x < newFont->info.chars; x++) {
+          newFont->chars[x].BBox = newFont->info.BBox;
+          newFont->chars[x].Metrics = newFont->info.Metrics;
+        }
+
+        ch = &newFont->chars[0];
+        break;
+      default:
+        bdfReadMetrics(kw, pos, end, &newFont->info.Metrics);
+        break;
+      }
+    } else if (ch) {
+      switch (kw) {
+      case KW_STARTCHAR:
+        bdfReadName(pos, end, ch->name, sizeof(ch->name));
+        isBitmap = 0;
+        break;
+      case KW_ENCODING:
+        bdfReadInts(pos, end, (int *const[]){&ch->encoding}, 1);
+        break;
+      case KW_BBX:
+        bdfReadBBox(pos, end, &ch->BBox);
+        break;
+      case KW_BITMAP:
+        // Rows are padded to whole bytes.
+        bitmapSize = ch->BBox.h > 0 && ch->BBox.w > 0 ? ch->BBox.h * ((ch->BBox.w + 7) / 8) : 0;
+
+        free(ch->bitmap);
+        ch->bitmap = calloc(bitmapSize ? bitmapSize : 1, 1);
+
+        if (ch->bitmap == NULL)
+          bitmapSize = 0;
 
-          bitmapSize = newFont->chars[curChar].BBox.h * (x / 8);
-
-          newFont->chars[curChar].bitmap = malloc(bitmapSize);
-
-          bzero(newFont->chars[curChar].bitmap, bitmapSize);
-
-          curBitmapPos = 0;
-          isBitmap = 1;
-        } else if (strcasecmp(cmdName, "ENDCHAR") == 0) {
-          curChar++;
-        } else if (strcasecmp(cmdName, "ENDFONT") == 0) {
-          endFont = 1;
-        } else {
-          if (isBitmap) {
-            for (x = 0, l = strlen(strPtr); x < l; x += 2) {
-              hexBuf[0] = strPtr[x];
-              hexBuf[1] = strPtr[x + 1];
-              hexBuf[2] = 0;
-              // FontChars[curChar].bitmap[curBitmapPos++] =
-              sscanf(hexBuf, "%x", &hex);
-
-              if (curBitmapPos < bitmapSize)
-                newFont->chars[curChar].bitmap[curBitmapPos++] = hex;
+        curBitmapPos = 0;
+        isBitmap = 1;
+        break;
+      case KW_ENDCHAR:
+        ch = ++curChar < newFont->info.chars ? &newFont->chars[curChar] : NULL;
+        isBitmap = 0;
+        break;
+      case KW_ENDFONT:
+        endFont = 1;
+        break;
+      case KW_NONE:
+        if (!isBitmap)
+          break;
+
+        // Every token of the line is a row of hex pairs.
+        for (; len; len = bdfToken(&pos, end, &token)) {
+          for (x = 0; x < len; x += 2) {
+            hi = hexDigits[(unsigned char)token[x]];
+
+            if (hi) {
+              lo = x + 1 < len ? hexDigits[(unsigned char)token[x + 1]] : 0;
+              hex = lo ? (hi & 0xF) << 4 | (lo & 0xF) : hi & 0xF;
             }
+
+            if (curBitmapPos < bitmapSize)
+              ch->bitmap[curBitmapPos++] = hex;
           }
         }
+        break;
+      default:
+        bdfReadMetrics(kw, pos, end, &ch->Metrics);
+        break;
       }
-
-      element++;
-      strPtr2 = NULL;
-      intPtr = NULL;
+    } else if (kw == KW_ENDFONT) {
+      endFont = 1;
     }
+
+    while (pos < end && *pos++ != '\n')
+      ;
   }
 
   return newFont;
@@ -502,11 +524,21 @@ void bdfSetDrawingFunction(void (*drawFunc)(int x, int y, int c, void *ctx), voi
   bdfDraw.ctx = ctx;
 }
 
+void bdfGetDrawingFunction(void (**drawFunc)(int x, int y, int c, void *ctx), void **ctx) {
+  *drawFunc = bdfDraw.function;
+  *ctx = bdfDraw.ctx;
+}
+
 void bdfSetDrawingAreaSize(int width, int height) {
   bdfDraw.areaWidth = width;
   bdfDraw.areaHeight = height;
 }
 
+void bdfGetDrawingAreaSize(int *width, int *height) {
+  *width = bdfDraw.areaWidth;
+  *height = bdfDraw.areaHeight;
+}
+
 void bdfSetDrawingWrap(int enabled) { bdfDraw.wrap = enabled; }
 
 int bdfGetDrawingCurrentX(void) { return bdfDraw.currentX; }
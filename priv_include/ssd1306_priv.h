@@ -0,0 +1,333 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief SSD1306 driver internals shared between the component's sources
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvbdflib.h"
+#include "ssd1306.h"
+#include "ssd1306_concurrent.h"
+#include "string.h"
+#include <stdatomic.h>
+#include <sys/param.h>
+
+#define SSD1306_WRITE_CMD (0x00)
+#define SSD1306_WRITE_DAT (0x40)
+
+#define SSD1306_PAGES (SSD1306_HEIGHT / 8)
+#define SSD1306_FB_SIZE (SSD1306_WIDTH * SSD1306_PAGES)
+#define SSD1306_CMD_MAX 32   // longest command transfer, without prefix
+#define SSD1306_TX_CHUNK 128 // bytes gathered per windowed data transfer
+
+// Bus cost of opening a GRAM window, in bytes: the address + control byte
+// and six command bytes (0x21/0x22 with their arguments), plus the address
+// and control byte that start the following data transfer.
+#define SSD1306_WINDOW_COST 10
+
+typedef struct ssd1306_layer ssd1306_layer_t;
+typedef struct ssd1306_cmd_queue ssd1306_cmd_queue_t;
+typedef struct ssd1306_gray ssd1306_gray_t;
+typedef struct ssd1306_mirror ssd1306_mirror_t;
+typedef struct ssd1306_widget ssd1306_widget_t;
+
+#define SSD1306_DAMAGE_RECTS 8
+
+// post_state flag: the command queue takes commands. The low bits count the
+// producers inside ssd1306_post_command, which stop waits out before freeing
+// the queue.
+#define SSD1306_POST_OPEN 0x80000000u
+
+// An inclusive rectangle in drawing coordinates.
+typedef struct {
+  int16_t x1;
+  int16_t y1;
+  int16_t x2;
+  int16_t y2;
+} ssd1306_rect_t;
+
+// A drawing target: the display framebuffer or an offscreen canvas. It is
+// the first member of both, so the drawing functions accept either handle
+// and only ever touch these fields.
+typedef struct {
+  uint8_t (*fb)[SSD1306_PAGES]; // columns of page bytes, panel layout
+  uint8_t columns;              // panel-coordinate size
+  uint8_t rows;                 // at most 64
+  bool transposed; // portrait: drawing coordinates are (y, x) on the panel
+  uint8_t width;   // drawing area, after rotation
+  uint8_t height;
+  BDF_FONT *bdf_font;
+  uint8_t clip_x1; // drawing clip, in panel coordinates
+  uint8_t clip_y1;
+  uint8_t clip_x2;
+  uint8_t clip_y2;
+  uint64_t clip_rows; // clip_y1..clip_y2 as a column word mask
+} ssd1306_surface_t;
+
+typedef struct {
+  ssd1306_surface_t surface; // must stay first
+  i2c_master_dev_handle_t i2c_dev_handle;
+  bool is_static;   // storage belongs to the caller
+  bool owns_shadow; // shadow was allocated by the driver
+  ssd1306_refresh_mode_t refresh_mode;
+  uint8_t (*shadow)[8]; // what the panel's GRAM holds, DIFF mode only
+  bool shadow_valid;
+  bool window_full; // GRAM address window covers the whole panel
+  uint8_t dirty[SSD1306_WIDTH]; // pages marked by ssd1306_mark_dirty
+  uint8_t tx_buf[1 + SSD1306_TX_CHUNK];
+  TaskHandle_t pacer_task;
+  TaskHandle_t pacer_waiter; // task blocked in ssd1306_stop_paced_refresh
+  atomic_bool pacer_run; // cleared after pacer_waiter is set
+  TickType_t pacer_period;
+  atomic_uint refresh_requests;
+  struct {
+    atomic_uint frames_sent;
+    atomic_uint frames_merged;
+    atomic_uint frames_skipped;
+    atomic_uint frames_dropped;
+    atomic_uint periods_missed;
+  } pacing; // ssd1306_pacing_stats_t, counted while it is read and reset
+  ssd1306_layer_t *layers; // bottom-most first
+  uint32_t compose_dirty[SSD1306_WIDTH / 32]; // columns to recomposite
+  ssd1306_rotation_t rotation;
+  bool mirror_x;
+  bool mirror_y;
+  ssd1306_widget_t *widgets; // top-level widgets, bottom-most first
+  ssd1306_rect_t damage[SSD1306_DAMAGE_RECTS];
+  uint8_t damage_count;
+  uint8_t seg_remap; // 0xA0/0xA1
+  uint8_t com_scan;  // 0xC0/0xC8
+  ssd1306_bus_config_t bus;
+  uint8_t bus_failures; // consecutive failed transfers
+  bool gram_lost;       // panel re-initialised during a refresh
+  bool tx_mirror;       // the frame being sent goes to the mirror
+  SemaphoreHandle_t lock;     // created by ssd1306_lock_create
+  SemaphoreHandle_t bus_lock; // held for a transfer, see ssd1306_lock_bus
+  uint8_t (*snapshot)[SSD1306_PAGES]; // copy of fb a refresh sends from
+  uint8_t (*tx_frame)[SSD1306_PAGES]; // what the transfer reads: fb or snapshot
+  ssd1306_cmd_queue_t *queue;
+  TaskHandle_t render_task;
+  TaskHandle_t render_waiter; // task blocked in ssd1306_concurrent_stop
+  atomic_bool render_run;     // cleared after render_waiter is set
+  atomic_uint post_state; // SSD1306_POST_OPEN | producers in post_command
+  bool auto_refresh;
+  bool gray_subframe; // fb holds a gray plane that is not mirrored
+  ssd1306_gray_t *gray; // grayscale mode state, while running
+  ssd1306_mirror_t *mirror; // mirror stream state, while running
+} ssd1306_dev_t;
+
+// A rectangular GRAM area, in columns and (hardware) pages.
+typedef struct {
+  uint8_t c0, c1;
+  uint8_t p0, p1;
+} ssd1306_window_t;
+
+/**
+ * @brief   Column words of 8 bitmap columns
+ *
+ * Fills cols[c] with column 8 * chByteCol + c of a row-major bitmap, row 0 at
+ * the top bit, using one 8x8 transpose per 8-row block.
+ */
+void ssd1306_bitmap_columns(const uint8_t *pchBmp, uint16_t byteWidth,
+                            uint16_t chByteCol, uint8_t chHeight,
+                            uint64_t cols[8]);
+
+/**
+ * @brief   Walk the points of a line as ssd1306_draw_line does, calling
+ *          plot(ctx, x, y) for each
+ */
+void ssd1306_line_points(int16_t chXpos1, int16_t chYpos1, int16_t chXpos2,
+                         int16_t chYpos2,
+                         void (*plot)(void *ctx, int16_t x, int16_t y),
+                         void *ctx);
+
+/**
+ * @brief   BDF pixel callback, ctx is the target surface
+ */
+void bdf_drawing_function(int x, int y, int c, void *ctx);
+
+/**
+ * @brief   First glyph of a BDF font with the given encoding, as
+ *          bdfPrintCharacter finds it, or NULL
+ */
+const FontChar *ssd1306_font_char(const BDF_FONT *font, int chr);
+
+/**
+ * @brief   Run one drawing command on a display or canvas; refresh commands
+ *          are ignored
+ */
+void ssd1306_apply_command(ssd1306_handle_t dev, const ssd1306_cmd_t *cmd);
+
+/**
+ * @brief   Create the device lock, the bus lock and the refresh snapshot,
+ *          unless they exist
+ */
+esp_err_t ssd1306_lock_create(ssd1306_dev_t *device);
+
+/**
+ * @brief   Take the device lock, then the bus lock
+ *
+ * A busy bus is waited for with the device lock released, so a transfer in
+ * flight holds up other refreshes but never drawing. Release with
+ * ssd1306_unlock_bus and ssd1306_unlock, in either order. Holders of the
+ * bus lock alone must not take the device lock.
+ */
+void ssd1306_lock_bus(ssd1306_dev_t *device);
+
+/**
+ * @brief   Release the bus lock taken by ssd1306_lock_bus
+ */
+void ssd1306_unlock_bus(ssd1306_dev_t *device);
+
+/**
+ * @brief   ssd1306_refresh_gram for a caller holding the device lock once,
+ *          which is given up as soon as the frame has been copied
+ */
+esp_err_t ssd1306_refresh_and_unlock(ssd1306_dev_t *device);
+
+/**
+ * @brief   Show frame, the framebuffer or the snapshot filled by the caller,
+ *          as the next full frame and copy it into the framebuffer; call
+ *          with ssd1306_lock_bus held once, which is given up
+ */
+esp_err_t ssd1306_refresh_frame_and_unlock(ssd1306_dev_t *device,
+                                          uint8_t (*frame)[SSD1306_PAGES]);
+
+/**
+ * @brief   Send a window of the framebuffer as a refresh would, with the
+ *          retries and recovery of ssd1306_set_bus_config, and update the
+ *          shadow; call with the bus lock held
+ */
+esp_err_t ssd1306_send_fb_window(ssd1306_dev_t *device,
+                                 const ssd1306_window_t *win);
+
+/**
+ * @brief   Point the GRAM address window at an area of the panel
+ */
+esp_err_t ssd1306_set_window(ssd1306_dev_t *device,
+                             const ssd1306_window_t *win);
+
+typedef esp_err_t (*ssd1306_window_fn_t)(const ssd1306_window_t *win,
+                                         void *ctx);
+
+/**
+ * @brief   Group the pages flagged in masks (one bitmask per column) into
+ *          windows and call fn on each, stopping at the first error
+ *
+ * Columns are visited left to right and each flagged column is either
+ * merged into the open window (growing it to the bounding box) or starts a
+ * new one, whichever costs fewer bus bytes: merging pays for the unflagged
+ * bytes the bounding box drags in, splitting pays SSD1306_WINDOW_COST for
+ * another window setup.
+ */
+esp_err_t ssd1306_merge_windows(const uint8_t *masks, ssd1306_window_fn_t fn,
+                                void *ctx);
+
+/**
+ * @brief   Send the first len bytes gathered in tx_buf[1..] as GRAM data
+ */
+esp_err_t ssd1306_send_tx_buf(ssd1306_dev_t *device, uint16_t len);
+
+/**
+ * @brief   Queue what changed in frame for the mirror stream; call with the
+ *          bus lock held after every transfer that brought the panel up to
+ *          date with frame
+ */
+void ssd1306_mirror_capture(ssd1306_dev_t *device,
+                            const uint8_t (*frame)[SSD1306_PAGES]);
+
+// Incremental decoder for the run-length format of ssd1306_rle.h; an opcode
+// may span several ssd1306_rle_read calls. Sources that don't fit in memory
+// set refill, which points src/len at the next block and returns false at
+// the end of the data.
+typedef struct ssd1306_rle_reader ssd1306_rle_reader_t;
+struct ssd1306_rle_reader {
+  const uint8_t *src;
+  size_t len;       // bytes left at src
+  uint8_t op_left;  // bytes left to produce for the current opcode
+  bool op_run;      // current opcode is a run of op_byte
+  uint8_t op_byte;
+  bool (*refill)(ssd1306_rle_reader_t *reader);
+  void *ctx;
+};
+
+/**
+ * @brief   Decode the next n bytes into out; false if the data ends early
+ */
+bool ssd1306_rle_read(ssd1306_rle_reader_t *reader, uint8_t *out, size_t n);
+
+/**
+ * @brief   Copy the next n undecoded bytes into out; only valid between
+ *          opcodes
+ */
+bool ssd1306_rle_read_raw(ssd1306_rle_reader_t *reader, uint8_t *out,
+                          size_t n);
+
+/*
+ * Column words
+ *
+ * A framebuffer column is 8 page bytes, page 0 first. Loaded as a
+ * little-endian 64-bit word (all ESP32 targets are little-endian), pixel row
+ * y sits at bit 63 - y, so moving content down by n rows is a right shift by
+ * n and a run of rows is a contiguous bit mask.
+ */
+
+static inline uint64_t ssd1306_column_load(const uint8_t *column) {
+  uint64_t word;
+  memcpy(&word, column, sizeof(word));
+  return word;
+}
+
+static inline void ssd1306_column_store(uint8_t *column, uint64_t word) {
+  memcpy(column, &word, sizeof(word));
+}
+
+// Bits of rows y0..y1 (inclusive, 0 <= y0 <= y1 <= 63).
+static inline uint64_t ssd1306_row_mask(int y0, int y1) {
+  return (UINT64_MAX >> y0) & (UINT64_MAX << (63 - y1));
+}
+
+static inline bool ssd1306_clip_column(const ssd1306_surface_t *surface,
+                                       int16_t x) {
+  return x >= surface->clip_x1 && x <= surface->clip_x2;
+}
+
+static inline void ssd1306_surface_reset_clip(ssd1306_surface_t *surface) {
+  surface->clip_x1 = 0;
+  surface->clip_y1 = 0;
+  surface->clip_x2 = surface->columns - 1;
+  surface->clip_y2 = surface->rows - 1;
+  surface->clip_rows = ssd1306_row_mask(0, surface->rows - 1);
+}
+
+// Move a column word down by dy rows (up when negative), dropping rows that
+// leave the 64-row column.
+static inline uint64_t ssd1306_column_shift(uint64_t word, int dy) {
+  if (dy >= 64 || dy <= -64) {
+    return 0;
+  }
+  return dy >= 0 ? word >> dy : word << -dy;
+}
+
+// Transpose an 8x8 bit matrix held as 8 bytes, row 0 in the top byte and
+// column 0 in bit 7 of each row (Hacker's Delight, 7-3).
+static inline uint64_t ssd1306_transpose8(uint64_t x) {
+  uint64_t t;
+
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+  x = x ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+  x = x ^ t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+  x = x ^ t ^ (t << 28);
+  return x;
+}
@@ -8,11 +8,23 @@
 // Copyright 20
 #include "ssd1306.h"
 #include "driver/i2c_master.h"
+#include "esp_rom_crc.h"
 #include "nvbdflib.h"
+#include "ssd1306_concurrent.h"
+#include "ssd1306_gray.h"
+#include "ssd1306_layer.h"
+#include "ssd1306_mirror.h"
+#include "ssd1306_priv.h"
+#include "ssd1306_ui.h"
 #include "string.h" // for memset
+#include <stddef.h>
 
-#define SSD1306_WRITE_CMD (0x00)
-#define SSD1306_WRITE_DAT (0x40)
+#ifndef SSD1306_PACER_STACK_SIZE
+#define SSD1306_PACER_STACK_SIZE 3072
+#endif
+#ifndef SSD1306_PACER_PRIORITY
+#define SSD1306_PACER_PRIORITY 5
+#endif
 
 #define COORDINATE_SWAP(x1, x2, y1, y2)                                        \
   {                                                                            \
@@ -23,42 +35,19 @@
     y2 = temp;                                                                 \
   }
 
-typedef struct {
-  i2c_master_dev_handle_t i2c_dev_handle;
-  uint8_t s_chDisplayBuffer[128][8];
-  BDF_FONT *bdf_font;
-} ssd1306_dev_t;
-
-static esp_err_t ssd1306_write_data(ssd1306_handle_t dev,
-                                    const uint8_t *const data,
-                                    const uint16_t data_len) {
-  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
-  esp_err_t ret;
-
-  uint8_t *out_buf = (uint8_t *)calloc(data_len + 1, sizeof(uint8_t));
-  out_buf[0] = SSD1306_WRITE_DAT;
-  memcpy(out_buf + 1, data, data_len);
-  ret =
-      i2c_master_transmit(device->i2c_dev_handle, out_buf, data_len + 1, 1000);
-  free(out_buf);
-
-  return ret;
-}
-
 static esp_err_t ssd1306_write_cmd(ssd1306_handle_t dev,
                                    const uint8_t *const data,
                                    const uint16_t data_len) {
   ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
-  esp_err_t ret;
+  uint8_t out_buf[1 + SSD1306_CMD_MAX];
 
-  uint8_t *out_buf = (uint8_t *)calloc(data_len + 1, sizeof(uint8_t));
+  if (data_len > SSD1306_CMD_MAX) {
+    return ESP_ERR_INVALID_SIZE;
+  }
   out_buf[0] = SSD1306_WRITE_CMD;
   memcpy(out_buf + 1, data, data_len);
-  ret =
-      i2c_master_transmit(device->i2c_dev_handle, out_buf, data_len + 1, 1000);
-  free(out_buf);
-
-  return ret;
+  return i2c_master_transmit(device->i2c_dev_handle, out_buf, data_len + 1,
+                             device->bus.timeout_ms);
 }
 
 static inline esp_err_t ssd1306_write_cmd_byte(ssd1306_handle_t dev,
@@ -66,24 +55,241 @@ static inline esp_err_t ssd1306_write_cmd_byte(ssd1306_handle_t dev,
   return ssd1306_write_cmd(dev, &cmd, 1);
 }
 
+esp_err_t ssd1306_send_tx_buf(ssd1306_dev_t *device, uint16_t len) {
+  device->tx_buf[0] = SSD1306_WRITE_DAT;
+  return i2c_master_transmit(device->i2c_dev_handle, device->tx_buf, len + 1,
+                             device->bus.timeout_ms);
+}
+
+esp_err_t ssd1306_set_window(ssd1306_dev_t *device,
+                             const ssd1306_window_t *win) {
+  const uint8_t cmd[6] = {0x21, win->c0, win->c1, 0x22, win->p0, win->p1};
+
+  device->window_full = win->c0 == 0 && win->c1 == SSD1306_WIDTH - 1 &&
+                        win->p0 == 0 && win->p1 == SSD1306_PAGES - 1;
+  return ssd1306_write_cmd(device, cmd, sizeof(cmd));
+}
+
+// Send a GRAM window from tx_frame. With vertical addressing the panel
+// expects the window column by column, so the pages of each column are
+// gathered into tx_buf and pushed in chunks; the GRAM pointer carries over
+// from one data transfer to the next.
+static esp_err_t ssd1306_write_window(ssd1306_dev_t *device,
+                                      const ssd1306_window_t *win) {
+  esp_err_t ret;
+  uint16_t len = 0;
+  uint8_t pages = win->p1 - win->p0 + 1;
+
+  if ((ret = ssd1306_set_window(device, win)) != ESP_OK) {
+    return ret;
+  }
+
+  for (uint16_t x = win->c0; x <= win->c1; x++) {
+    if (len + pages > SSD1306_TX_CHUNK) {
+      if ((ret = ssd1306_send_tx_buf(device, len)) != ESP_OK) {
+        return ret;
+      }
+      len = 0;
+    }
+    memcpy(&device->tx_buf[1 + len], &device->tx_frame[x][win->p0], pages);
+    len += pages;
+  }
+
+  return ssd1306_send_tx_buf(device, len);
+}
+
+static esp_err_t ssd1306_init_panel(ssd1306_dev_t *device);
+
+// Reset the bus and send the panel command sequence again, keeping the
+// framebuffer. Whatever the panel showed is no longer trusted.
+static void ssd1306_recover(ssd1306_dev_t *device) {
+  if (device->bus.bus_handle) {
+    i2c_master_bus_reset(device->bus.bus_handle);
+  }
+  if (ssd1306_init_panel(device) == ESP_OK) {
+    ssd1306_write_cmd_byte(device, 0xAF);
+  }
+  device->shadow_valid = false;
+  device->gram_lost = true;
+}
+
+// Send one window, retrying it with a doubling, capped backoff. Counts
+// consecutive failures across calls and re-initialises the panel once
+// reinit_after of them have piled up.
+static esp_err_t ssd1306_write_window_retry(ssd1306_dev_t *device,
+                                            const ssd1306_window_t *win) {
+  uint32_t backoff = device->bus.backoff_ms;
+  esp_err_t ret;
+
+  for (uint8_t attempt = 0;; attempt++) {
+    if ((ret = ssd1306_write_window(device, win)) == ESP_OK) {
+      device->bus_failures = 0;
+      return ESP_OK;
+    }
+    if (device->bus.reinit_after &&
+        ++device->bus_failures >= device->bus.reinit_after) {
+      device->bus_failures = 0;
+      ssd1306_recover(device);
+    }
+    if (attempt >= device->bus.retries) {
+      return ret;
+    }
+    if (backoff) {
+      vTaskDelay(pdMS_TO_TICKS(backoff));
+      backoff = MIN(backoff * 2,
+                    MAX(device->bus.backoff_ms, device->bus.backoff_max_ms));
+    }
+  }
+}
+
+// Send a window from tx_frame. In chunked mode it goes out as
+// sub-windows of whole columns holding at most SSD1306_TX_CHUNK bytes, one
+// data transfer each, so a failure only costs that chunk.
+static esp_err_t ssd1306_send_window(ssd1306_dev_t *device,
+                                     const ssd1306_window_t *win) {
+  uint8_t pages = win->p1 - win->p0 + 1;
+  uint8_t step = SSD1306_TX_CHUNK / pages;
+  esp_err_t ret;
+
+  if (!device->bus.chunked) {
+    return ssd1306_write_window_retry(device, win);
+  }
+  for (uint16_t c0 = win->c0; c0 <= win->c1; c0 += step) {
+    ssd1306_window_t chunk = {c0, MIN(c0 + step - 1, win->c1), win->p0,
+                              win->p1};
+    if ((ret = ssd1306_write_window_retry(device, &chunk)) != ESP_OK) {
+      return ret;
+    }
+  }
+  return ESP_OK;
+}
+
+static inline uint16_t ssd1306_window_area(const ssd1306_window_t *win) {
+  return (win->c1 - win->c0 + 1) * (win->p1 - win->p0 + 1);
+}
+
+// Bitmask of the pages in column x of tx_frame whose bytes differ from the
+// shadow. The column is compared as two 32-bit words first, so unchanged
+// columns cost two compares.
+static inline uint8_t ssd1306_column_diff(const ssd1306_dev_t *device,
+                                          uint8_t x) {
+  uint32_t cur[2], old[2];
+  uint8_t mask = 0;
+
+  memcpy(cur, device->tx_frame[x], sizeof(cur));
+  memcpy(old, device->shadow[x], sizeof(old));
+  if (cur[0] == old[0] && cur[1] == old[1]) {
+    return 0;
+  }
+  for (uint8_t p = 0; p < SSD1306_PAGES; p++) {
+    if (device->tx_frame[x][p] != device->shadow[x][p]) {
+      mask |= 1 << p;
+    }
+  }
+  return mask;
+}
+
+static esp_err_t ssd1306_flush_window(ssd1306_dev_t *device,
+                                      const ssd1306_window_t *win) {
+  esp_err_t ret = ssd1306_send_window(device, win);
+
+  if (ret == ESP_OK && device->shadow) {
+    uint8_t pages = win->p1 - win->p0 + 1;
+    for (uint16_t x = win->c0; x <= win->c1; x++) {
+      memcpy(&device->shadow[x][win->p0], &device->tx_frame[x][win->p0],
+             pages);
+    }
+  }
+  return ret;
+}
+
+esp_err_t ssd1306_merge_windows(const uint8_t *masks,
+                                ssd1306_window_fn_t fn, void *ctx) {
+  esp_err_t ret;
+  ssd1306_window_t win = {0};
+  bool open = false;
+
+  for (uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+    uint8_t mask = masks[x];
+    if (!mask) {
+      continue;
+    }
+
+    ssd1306_window_t col = {x, x, __builtin_ctz(mask), 31 - __builtin_clz(mask)};
+    if (open) {
+      ssd1306_window_t merged = {win.c0, x, MIN(win.p0, col.p0),
+                                 MAX(win.p1, col.p1)};
+      if (ssd1306_window_area(&merged) <=
+          ssd1306_window_area(&win) + ssd1306_window_area(&col) +
+              SSD1306_WINDOW_COST) {
+        win = merged;
+        continue;
+      }
+      if ((ret = fn(&win, ctx)) != ESP_OK) {
+        return ret;
+      }
+    }
+    win = col;
+    open = true;
+  }
+
+  return open ? fn(&win, ctx) : ESP_OK;
+}
+
+esp_err_t ssd1306_send_fb_window(ssd1306_dev_t *device,
+                                 const ssd1306_window_t *win) {
+  device->tx_frame = device->surface.fb;
+  return ssd1306_flush_window(device, win);
+}
+
+static esp_err_t ssd1306_flush_window_fn(const ssd1306_window_t *win,
+                                         void *ctx) {
+  return ssd1306_flush_window((ssd1306_dev_t *)ctx, win);
+}
+
+// Send the pages flagged in masks as a series of windows.
+static esp_err_t ssd1306_refresh_windows(ssd1306_dev_t *device,
+                                         const uint8_t *masks) {
+  return ssd1306_merge_windows(masks, ssd1306_flush_window_fn, device);
+}
+
+// Compare tx_frame against the shadow GRAM and send the changes.
+static esp_err_t ssd1306_refresh_diff(ssd1306_dev_t *device) {
+  uint8_t masks[SSD1306_WIDTH];
+
+  for (uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+    masks[x] = ssd1306_column_diff(device, x);
+  }
+  return ssd1306_refresh_windows(device, masks);
+}
+
 void ssd1306_fill_rectangle(ssd1306_handle_t dev, uint8_t chXpos1,
                             uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
                             uint8_t chDot) {
-  uint8_t chXpos, chYpos;
+  ssd1306_span_t span = {chXpos1, chYpos1, MIN(chYpos2 - chYpos1 + 1, 255)};
 
-  for (chXpos = chXpos1; chXpos <= chXpos2; chXpos++) {
-    for (chYpos = chYpos1; chYpos <= chYpos2; chYpos++) {
-      ssd1306_fill_point(dev, chXpos, chYpos, chDot);
-    }
+  if (chXpos1 > chXpos2 || chYpos1 > chYpos2) {
+    return;
+  }
+  // one vertical span per column
+  for (uint16_t chXpos = chXpos1; chXpos <= chXpos2; chXpos++) {
+    span.x = chXpos;
+    ssd1306_fill_vspans(dev, &span, 1, chDot);
   }
 }
 
 void ssd1306_fill_point(ssd1306_handle_t dev, uint8_t chXpos, uint8_t chYpos,
                         uint8_t chPoint) {
-  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
   uint8_t chPos, chBx, chTemp = 0;
 
-  if (chXpos > 127 || chYpos > 63) {
+  if (surface->transposed) {
+    chTemp = chXpos;
+    chXpos = chYpos;
+    chYpos = chTemp;
+  }
+  if (chXpos < surface->clip_x1 || chXpos > surface->clip_x2 ||
+      chYpos < surface->clip_y1 || chYpos > surface->clip_y2) {
     return;
   }
   chPos = 7 - chYpos / 8;
@@ -91,28 +297,86 @@ void ssd1306_fill_point(ssd1306_handle_t dev, uint8_t chXpos, uint8_t chYpos,
   chTemp = 1 << (7 - chBx);
 
   if (chPoint) {
-    device->s_chDisplayBuffer[chXpos][chPos] |= chTemp;
+    surface->fb[chXpos][chPos] |= chTemp;
   } else {
-    device->s_chDisplayBuffer[chXpos][chPos] &= ~chTemp;
+    surface->fb[chXpos][chPos] &= ~chTemp;
+  }
+}
+
+void ssd1306_bitmap_columns(const uint8_t *pchBmp, uint16_t byteWidth,
+                            uint16_t chByteCol, uint8_t chHeight,
+                            uint64_t cols[8]) {
+  const uint8_t *src = pchBmp + chByteCol;
+
+  memset(cols, 0, 8 * sizeof(cols[0]));
+  for (uint8_t j0 = 0; j0 < chHeight; j0 += 8) {
+    uint64_t block = 0;
+    for (uint8_t j = j0; j < j0 + 8 && j < chHeight; j++, src += byteWidth) {
+      block |= (uint64_t)*src << (56 - 8 * (j - j0));
+    }
+    if (!block) {
+      continue;
+    }
+    block = ssd1306_transpose8(block);
+    for (uint8_t c = 0; c < 8; c++) {
+      cols[c] |= (block >> (56 - 8 * c) & 0xFF) << (56 - j0);
+    }
   }
 }
 
 void ssd1306_draw_bitmap(ssd1306_handle_t dev, uint8_t chXpos, uint8_t chYpos,
                          const uint8_t *pchBmp, uint8_t chWidth,
                          uint8_t chHeight) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
   uint16_t i, j, byteWidth = (chWidth + 7) / 8;
+  uint64_t cols[8];
+
+  if (chXpos >= surface->width || chYpos >= surface->height) {
+    return;
+  }
+  chWidth = MIN(chWidth, surface->width - chXpos);
+  chHeight = MIN(chHeight, surface->height - chYpos);
 
-  for (j = 0; j < chHeight; j++) {
-    for (i = 0; i < chWidth; i++) {
-      if (*(pchBmp + j * byteWidth + i / 8) & (128 >> (i & 7))) {
-        ssd1306_fill_point(dev, chXpos + i, chYpos + j, 1);
+  uint16_t visible = (chWidth + 7) / 8; // bitmap bytes left after clipping
+
+  if (surface->transposed) {
+    // bitmap rows are panel columns, and a row byte is already a vertical
+    // run of 8 pixels in page-byte bit order
+    uint8_t last = 0xFF << (8 * visible - chWidth);
+    for (j = 0; j < chHeight; j++) {
+      const uint8_t *row = pchBmp + j * byteWidth;
+      uint64_t word = 0;
+      for (i = 0; i < visible; i++) {
+        uint8_t bits = i == visible - 1 ? row[i] & last : row[i];
+        word |= ((uint64_t)bits << 56) >> (chXpos + 8 * i);
+      }
+      if (!ssd1306_clip_column(surface, chYpos + j)) {
+        continue;
       }
+      uint8_t *col = surface->fb[chYpos + j];
+      ssd1306_column_store(col, ssd1306_column_load(col) |
+                                    (word & surface->clip_rows));
+    }
+    return;
+  }
+
+  for (i = 0; i < visible; i++) {
+    ssd1306_bitmap_columns(pchBmp, byteWidth, i, chHeight, cols);
+    for (j = 0; j < 8 && 8 * i + j < chWidth; j++) {
+      if (!ssd1306_clip_column(surface, chXpos + 8 * i + j)) {
+        continue;
+      }
+      uint8_t *col = surface->fb[chXpos + 8 * i + j];
+      ssd1306_column_store(col, ssd1306_column_load(col) |
+                                    (cols[j] >> chYpos & surface->clip_rows));
     }
   }
 }
 
-void ssd1306_draw_line(ssd1306_handle_t dev, int16_t chXpos1, int16_t chYpos1,
-                       int16_t chXpos2, int16_t chYpos2) {
+void ssd1306_line_points(int16_t chXpos1, int16_t chYpos1, int16_t chXpos2,
+                         int16_t chYpos2,
+                         void (*plot)(void *ctx, int16_t x, int16_t y),
+                         void *ctx) {
   // 16-bit variables allowing a display overflow effect
   int16_t x_len = abs(chXpos1 - chXpos2);
   int16_t y_len = abs(chYpos1 - chYpos2);
@@ -135,7 +399,7 @@ void ssd1306_draw_line(ssd1306_handle_t dev, int16_t chXpos1, int16_t chYpos1,
       }
 
       diff += y_len;
-      ssd1306_fill_point(dev, chXpos1++, chYpos1, 1);
+      plot(ctx, chXpos1++, chYpos1);
     } while (len--);
   }
 
@@ -157,40 +421,58 @@ void ssd1306_draw_line(ssd1306_handle_t dev, int16_t chXpos1, int16_t chYpos1,
       }
 
       diff += x_len;
-      ssd1306_fill_point(dev, chXpos1, chYpos1++, 1);
+      plot(ctx, chXpos1, chYpos1++);
     } while (len--);
   }
 }
 
+static void ssd1306_line_plot(void *ctx, int16_t x, int16_t y) {
+  ssd1306_fill_point(ctx, x, y, 1);
+}
+
+void ssd1306_draw_line(ssd1306_handle_t dev, int16_t chXpos1, int16_t chYpos1,
+                       int16_t chXpos2, int16_t chYpos2) {
+  ssd1306_line_points(chXpos1, chYpos1, chXpos2, chYpos2, ssd1306_line_plot,
+                      dev);
+}
+
 void bdf_drawing_function(int x, int y, int c, void *ctx) {
-  ssd1306_dev_t *device = (ssd1306_dev_t *)ctx;
-  ssd1306_fill_point(device, x, y, c);
+  ssd1306_fill_point(ctx, x, y, c);
+}
+
+const FontChar *ssd1306_font_char(const BDF_FONT *font, int chr) {
+  for (int i = 0; i < font->info.chars; i++) {
+    if (font->chars[i].encoding == chr) {
+      return &font->chars[i];
+    }
+  }
+  return NULL;
 }
 
 esp_err_t ssd1306_load_bdf_buffer(ssd1306_handle_t dev, void *buffer,
                                   int length, bool wrap) {
-  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
 
-  if (!(device->bdf_font = bdfReadBuffer(buffer, length))) {
+  if (!(surface->bdf_font = bdfReadBuffer(buffer, length))) {
     return ESP_FAIL;
   }
 
-  bdfSetDrawingFunction(bdf_drawing_function, (void *)device);
-  bdfSetDrawingAreaSize(128, 64);
+  bdfSetDrawingFunction(bdf_drawing_function, (void *)surface);
+  bdfSetDrawingAreaSize(surface->width, surface->height);
   bdfSetDrawingWrap(wrap);
 
   return ESP_OK;
 };
 
 esp_err_t ssd1306_load_bdf_file(ssd1306_handle_t dev, FILE *file, bool wrap) {
-  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
 
-  if (!(device->bdf_font = bdfReadFile(file))) {
+  if (!(surface->bdf_font = bdfReadFile(file))) {
     return ESP_FAIL;
   }
 
-  bdfSetDrawingFunction(bdf_drawing_function, (void *)device);
-  bdfSetDrawingAreaSize(128, 64);
+  bdfSetDrawingFunction(bdf_drawing_function, (void *)surface);
+  bdfSetDrawingAreaSize(surface->width, surface->height);
   bdfSetDrawingWrap(wrap);
 
   return ESP_OK;
@@ -198,75 +480,600 @@ esp_err_t ssd1306_load_bdf_file(ssd1306_handle_t dev, FILE *file, bool wrap) {
 
 void ssd1306_draw_bdf_text(ssd1306_handle_t dev, uint8_t chXpos, uint8_t chYpos,
                            const char *string) {
-  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
-  bdfPrintString(device->bdf_font, chXpos, chYpos, (char *)string);
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+  bdfSetDrawingFunction(bdf_drawing_function, (void *)surface);
+  bdfSetDrawingAreaSize(surface->width, surface->height);
+  bdfPrintString(surface->bdf_font, chXpos, chYpos, (char *)string);
 };
 
+// The panel command sequence, sent as one command transfer. Leaves the
+// display off, in vertical addressing mode with the full GRAM window.
+static esp_err_t ssd1306_init_panel(ssd1306_dev_t *device) {
+  const uint8_t cmd[] = {
+      0xAE,               //--turn off oled panel
+      0x40,               //--set start line address  Set Mapping RAM
+                          // Display Start Line (0x00~0x3F)
+      0x81,               //--set contrast control register
+      0xCF,               // Set SEG Output Current Brightness
+      device->seg_remap,  //--Set SEG/Column Mapping
+      device->com_scan,   // Set COM/Row Scan Direction
+      0xA6,               //--set normal display
+      0xA8,               //--set multiplex ratio(1 to 64)
+      0x3f,               //--1/64 duty
+      0xd5,               //--set display clock divide ratio/oscillator frequency
+      0x80,               //--set divide ratio, Set Clock as 100 Frames/Sec
+      0xD9,               //--set pre-charge period
+      0xF1,               // Set Pre-Charge as 15 Clocks & Discharge as 1 Clock
+      0xDA,               //--set com pins hardware configuration
+      0xDB,               //--set vcomh
+      0x40,               // Set VCOM Deselect Level
+      0x8D,               //--set Charge Pump enable/disable
+      0x14,               //--set(0x10) disable
+      0xA4,               // Disable Entire Display On (0xa4/0xa5)
+      0xA6,               // Disable Inverse Display On (0xa6/a7)
+      0x20, 1,            //-- set vertical adressing mode
+      0x21, 0, 127,       //--set column address to zero
+      0x22, 0, 7,         //--set row address to zero
+  };
+
+  device->window_full = true;
+  device->shadow_valid = false;
+  return ssd1306_write_cmd(device, cmd, sizeof(cmd));
+}
+
 esp_err_t ssd1306_init(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
   esp_err_t ret;
 
-  ssd1306_write_cmd_byte(dev, 0xAE); //--turn off oled panel
-  ssd1306_write_cmd_byte(dev, 0x40); //--set start line address  Set Mapping RAM
-                                     // Display Start Line (0x00~0x3F)
-  ssd1306_write_cmd_byte(dev, 0x81); //--set contrast control register
-  ssd1306_write_cmd_byte(dev, 0xCF); // Set SEG Output Current Brightness
-  ssd1306_write_cmd_byte(dev, 0xA1); //--Set SEG/Column Mapping
-  ssd1306_write_cmd_byte(dev, 0xC0); // Set COM/Row Scan Direction
-  ssd1306_write_cmd_byte(dev, 0xA6); //--set normal display
-  ssd1306_write_cmd_byte(dev, 0xA8); //--set multiplex ratio(1 to 64)
-  ssd1306_write_cmd_byte(dev, 0x3f); //--1/64 duty
-  ssd1306_write_cmd_byte(
-      dev, 0xd5); //--set display clock divide ratio/oscillator frequency
-  ssd1306_write_cmd_byte(
-      dev, 0x80); //--set divide ratio, Set Clock as 100 Frames/Sec
-  ssd1306_write_cmd_byte(dev, 0xD9); //--set pre-charge period
-  ssd1306_write_cmd_byte(
-      dev, 0xF1); // Set Pre-Charge as 15 Clocks & Discharge as 1 Clock
-  ssd1306_write_cmd_byte(dev, 0xDA); //--set com pins hardware configuration
-  ssd1306_write_cmd_byte(dev, 0xDB); //--set vcomh
-  ssd1306_write_cmd_byte(dev, 0x40); // Set VCOM Deselect Level
-  ssd1306_write_cmd_byte(dev, 0x8D); //--set Charge Pump enable/disable
-  ssd1306_write_cmd_byte(dev, 0x14); //--set(0x10) disable
-  ssd1306_write_cmd_byte(dev, 0xA4); // Disable Entire Display On (0xa4/0xa5)
-  ssd1306_write_cmd_byte(dev, 0xA6); // Disable Inverse Display On (0xa6/a7)
-
-  const uint8_t cmd[2] = {0x20, 1}; //-- set vertical adressing mode
-  ssd1306_write_cmd(dev, cmd, sizeof(cmd));
-
-  uint8_t cmd2[3] = {0x21, 0, 127};
-  ssd1306_write_cmd(dev, cmd2, sizeof(cmd2)); //--set column address to zero
-  cmd2[0] = 0x22;
-  cmd2[2] = 7;
-  ssd1306_write_cmd(dev, cmd2, sizeof(cmd2)); //--set row address to zero
+  if ((ret = ssd1306_init_panel(device)) != ESP_OK) {
+    return ret;
+  }
 
   ssd1306_clear_screen(dev, 0x00);
-  ssd1306_refresh_gram(dev);
+  if ((ret = ssd1306_refresh_gram(dev)) != ESP_OK) {
+    return ret;
+  }
 
-  ret = ssd1306_write_cmd_byte(dev, 0xAF); //--turn on oled panel
-  ret = 0;
+  return ssd1306_write_cmd_byte(dev, 0xAF); //--turn on oled panel
+}
+
+esp_err_t ssd1306_set_refresh_mode(ssd1306_handle_t dev,
+                                   ssd1306_refresh_mode_t mode) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  esp_err_t ret = ESP_OK;
+
+  ssd1306_lock_bus(device); // a transfer may be using the shadow
+  if (mode == SSD1306_REFRESH_DIFF && !device->shadow) {
+    device->shadow = calloc(SSD1306_WIDTH, sizeof(*device->shadow));
+    if (device->shadow) {
+      device->owns_shadow = true;
+      device->shadow_valid = false;
+    } else {
+      ret = ESP_ERR_NO_MEM;
+    }
+  } else if (mode == SSD1306_REFRESH_FULL && device->owns_shadow) {
+    free(device->shadow);
+    device->shadow = NULL;
+    device->owns_shadow = false;
+  }
+  if (ret == ESP_OK) {
+    device->refresh_mode = mode;
+  }
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
 
   return ret;
 }
 
-ssd1306_handle_t ssd1306_create(i2c_master_dev_handle_t i2c_dev_handle) {
-  ssd1306_dev_t *dev = (ssd1306_dev_t *)calloc(1, sizeof(ssd1306_dev_t));
+void ssd1306_invalidate_gram(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  device->shadow_valid = false;
+}
+
+esp_err_t ssd1306_set_bus_config(ssd1306_handle_t dev,
+                                 const ssd1306_bus_config_t *config) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (!config->timeout_ms) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  device->bus = *config;
+  device->bus_failures = 0;
+
+  return ESP_OK;
+}
+
+// Sends at most one frame per period. Requests that arrive while a frame is
+// pending are folded into it, so the bus load is bounded by the frame rate no
+// matter how many tasks call ssd1306_request_refresh.
+static void ssd1306_pacer_task(void *arg) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)arg;
+  TickType_t wake = xTaskGetTickCount();
+
+  while (atomic_load(&device->pacer_run)) {
+    if (xTaskDelayUntil(&wake, device->pacer_period) == pdFALSE) {
+      // the previous transfer overran its slot; don't try to catch up
+      atomic_fetch_add(&device->pacing.periods_missed, 1);
+      wake = xTaskGetTickCount();
+    }
+
+    unsigned int requests = atomic_exchange(&device->refresh_requests, 0);
+    if (!requests) {
+      atomic_fetch_add(&device->pacing.frames_skipped, 1);
+      continue;
+    }
+    atomic_fetch_add(&device->pacing.frames_merged, requests - 1);
+
+    if (ssd1306_refresh_gram(device) == ESP_OK) {
+      atomic_fetch_add(&device->pacing.frames_sent, 1);
+    } else {
+      atomic_fetch_add(&device->pacing.frames_dropped, 1);
+      atomic_fetch_add(&device->refresh_requests, 1); // retry next period
+    }
+  }
+
+  xTaskNotifyGive(device->pacer_waiter);
+  vTaskDelete(NULL);
+}
+
+esp_err_t ssd1306_start_paced_refresh(ssd1306_handle_t dev, uint32_t fps) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (!fps) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (device->pacer_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  device->pacer_period = MAX(pdMS_TO_TICKS(1000 / fps), 1);
+  atomic_store(&device->pacer_run, true);
+  memset(&device->pacing, 0, sizeof(device->pacing)); // no task counting yet
+  if (xTaskCreate(ssd1306_pacer_task, "ssd1306_pacer", SSD1306_PACER_STACK_SIZE,
+                  device, SSD1306_PACER_PRIORITY,
+                  &device->pacer_task) != pdPASS) {
+    device->pacer_task = NULL;
+    atomic_store(&device->pacer_run, false);
+    return ESP_ERR_NO_MEM;
+  }
+
+  return ESP_OK;
+}
+
+void ssd1306_stop_paced_refresh(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (!device->pacer_task) {
+    return;
+  }
+  // the task reads pacer_waiter once it sees pacer_run cleared
+  device->pacer_waiter = xTaskGetCurrentTaskHandle();
+  atomic_store(&device->pacer_run, false);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  device->pacer_task = NULL;
+}
+
+void ssd1306_request_refresh(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  atomic_fetch_add(&device->refresh_requests, 1);
+}
+
+// Read a pacing counter, zeroing it in the same step when resetting so no
+// count from the pacer task is lost.
+static uint32_t ssd1306_pacing_read(atomic_uint *counter, bool reset) {
+  return reset ? atomic_exchange(counter, 0) : atomic_load(counter);
+}
+
+void ssd1306_get_pacing_stats(ssd1306_handle_t dev,
+                              ssd1306_pacing_stats_t *stats, bool reset) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  stats->frames_sent = ssd1306_pacing_read(&device->pacing.frames_sent, reset);
+  stats->frames_merged =
+      ssd1306_pacing_read(&device->pacing.frames_merged, reset);
+  stats->frames_skipped =
+      ssd1306_pacing_read(&device->pacing.frames_skipped, reset);
+  stats->frames_dropped =
+      ssd1306_pacing_read(&device->pacing.frames_dropped, reset);
+  stats->periods_missed =
+      ssd1306_pacing_read(&device->pacing.periods_missed, reset);
+}
+
+// Work out the panel remap for the rotation and mirroring. Portrait
+// orientations transpose the drawing coordinates; the panel then flips one
+// axis to turn that reflection into a quarter turn, and both axes for the
+// half turn.
+static void ssd1306_update_orientation(ssd1306_dev_t *device) {
+  bool flip_seg = device->rotation == SSD1306_ROTATION_90 ||
+                  device->rotation == SSD1306_ROTATION_180;
+  bool flip_com = device->rotation == SSD1306_ROTATION_180 ||
+                  device->rotation == SSD1306_ROTATION_270;
+
+  bool transposed = device->rotation == SSD1306_ROTATION_90 ||
+                    device->rotation == SSD1306_ROTATION_270;
+  // mirroring is along the rotated axes, which are swapped in portrait
+  flip_seg ^= transposed ? device->mirror_y : device->mirror_x;
+  flip_com ^= transposed ? device->mirror_x : device->mirror_y;
+
+  device->seg_remap = flip_seg ? 0xA0 : 0xA1;
+  device->com_scan = flip_com ? 0xC8 : 0xC0;
+  device->surface.transposed = transposed;
+  device->surface.width = transposed ? SSD1306_HEIGHT : SSD1306_WIDTH;
+  device->surface.height = transposed ? SSD1306_WIDTH : SSD1306_HEIGHT;
+  ssd1306_surface_reset_clip(&device->surface);
+}
+
+static esp_err_t ssd1306_apply_orientation(ssd1306_dev_t *device) {
+  uint8_t seg_remap = device->seg_remap;
+  esp_err_t ret;
+
+  ssd1306_lock_bus(device);
+  ssd1306_update_orientation(device);
+  if (device->seg_remap != seg_remap) {
+    // the segment remap only applies to GRAM written from now on
+    device->shadow_valid = false;
+  }
+
+  const uint8_t cmd[2] = {device->seg_remap, device->com_scan};
+  ret = ssd1306_write_cmd(device, cmd, sizeof(cmd));
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(device);
+  return ret;
+}
+
+esp_err_t ssd1306_set_rotation(ssd1306_handle_t dev,
+                               ssd1306_rotation_t rotation) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (rotation > SSD1306_ROTATION_270) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  device->rotation = rotation;
+  return ssd1306_apply_orientation(device);
+}
+
+esp_err_t ssd1306_set_mirror(ssd1306_handle_t dev, bool mirror_x,
+                             bool mirror_y) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  device->mirror_x = mirror_x;
+  device->mirror_y = mirror_y;
+  return ssd1306_apply_orientation(device);
+}
+
+#define SSD1306_RETAINED_MAGIC 0x31333036 // "1306"
+
+static uint32_t ssd1306_retained_crc(const ssd1306_retained_t *retained) {
+  return esp_rom_crc32_le(0, (const uint8_t *)retained,
+                          offsetof(ssd1306_retained_t, crc));
+}
+
+esp_err_t ssd1306_save_retained(ssd1306_handle_t dev,
+                                ssd1306_retained_t *retained) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  ssd1306_lock_bus(device);
+  memset(retained, 0, sizeof(*retained));
+  retained->magic = SSD1306_RETAINED_MAGIC;
+  retained->rotation = device->rotation;
+  retained->mirror_x = device->mirror_x;
+  retained->mirror_y = device->mirror_y;
+  // the shadow is what the panel holds when known, otherwise assume the
+  // framebuffer has just been sent
+  memcpy(retained->gram,
+         device->shadow_valid ? device->shadow : device->surface.fb,
+         SSD1306_FB_SIZE);
+  retained->crc = ssd1306_retained_crc(retained);
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
+
+  return ESP_OK;
+}
+
+esp_err_t ssd1306_warm_start(ssd1306_handle_t dev,
+                             const ssd1306_retained_t *retained) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (retained->magic != SSD1306_RETAINED_MAGIC ||
+      retained->rotation > SSD1306_ROTATION_270 ||
+      retained->crc != ssd1306_retained_crc(retained)) {
+    return ESP_ERR_INVALID_CRC;
+  }
+
+  ssd1306_lock_bus(device);
+  device->rotation = retained->rotation;
+  device->mirror_x = retained->mirror_x;
+  device->mirror_y = retained->mirror_y;
+  ssd1306_update_orientation(device);
+  memcpy(device->surface.fb, retained->gram, SSD1306_FB_SIZE);
+  if (device->shadow) {
+    memcpy(device->shadow, retained->gram, SSD1306_FB_SIZE);
+    device->shadow_valid = true;
+  }
+  device->window_full = false; // the GRAM window was left unknown
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
+
+  return ESP_OK;
+}
+
+uint8_t ssd1306_get_width(ssd1306_handle_t dev) {
+  return ((ssd1306_surface_t *)dev)->width;
+}
+
+uint8_t ssd1306_get_height(ssd1306_handle_t dev) {
+  return ((ssd1306_surface_t *)dev)->height;
+}
+
+uint8_t *ssd1306_get_framebuffer(ssd1306_handle_t dev) {
+  return &((ssd1306_surface_t *)dev)->fb[0][0];
+}
+
+esp_err_t ssd1306_set_shadow_buffer(ssd1306_handle_t dev, uint8_t *buffer) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (!buffer) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  ssd1306_lock_bus(device);
+  if (device->owns_shadow) {
+    free(device->shadow);
+  }
+  device->shadow = (uint8_t(*)[SSD1306_PAGES])buffer;
+  device->owns_shadow = false;
+  device->shadow_valid = false;
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
+
+  return ESP_OK;
+}
+
+_Static_assert(sizeof(ssd1306_dev_t) <= sizeof(ssd1306_storage_t),
+               "SSD1306_DEVICE_STORAGE_SIZE is too small");
+
+ssd1306_handle_t ssd1306_create_static(i2c_master_dev_handle_t i2c_dev_handle,
+                                       ssd1306_storage_t *storage,
+                                       uint8_t *framebuffer) {
+  if (!storage || !framebuffer) {
+    return NULL;
+  }
+  ssd1306_dev_t *dev = (ssd1306_dev_t *)storage;
+  memset(dev, 0, sizeof(*dev));
+  memset(framebuffer, 0, SSD1306_FRAMEBUFFER_SIZE);
+  framebuffer[0] = SSD1306_WRITE_DAT;
+  dev->surface.fb = (uint8_t(*)[SSD1306_PAGES])(framebuffer + 1);
+  dev->tx_frame = dev->surface.fb;
+  dev->surface.columns = SSD1306_WIDTH;
+  dev->surface.rows = SSD1306_HEIGHT;
+  ssd1306_surface_reset_clip(&dev->surface);
   dev->i2c_dev_handle = i2c_dev_handle;
+  dev->is_static = true;
+  dev->bus = (ssd1306_bus_config_t)SSD1306_BUS_CONFIG_DEFAULT();
+  ssd1306_update_orientation(dev);
+  return (ssd1306_handle_t)dev;
+}
+
+ssd1306_handle_t ssd1306_create(i2c_master_dev_handle_t i2c_dev_handle) {
+  // device object and framebuffer in one block
+  uint8_t *mem = malloc(sizeof(ssd1306_storage_t) + SSD1306_FRAMEBUFFER_SIZE);
+  if (!mem) {
+    return NULL;
+  }
+  ssd1306_dev_t *dev = ssd1306_create_static(
+      i2c_dev_handle, (ssd1306_storage_t *)mem, mem + sizeof(ssd1306_storage_t));
+  dev->is_static = false;
   ssd1306_init((ssd1306_handle_t)dev);
   return (ssd1306_handle_t)dev;
 }
 
 void ssd1306_delete(ssd1306_handle_t dev) {
   ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
-  free(device);
+  ssd1306_gray_stop(dev);
+  ssd1306_concurrent_stop(dev);
+  ssd1306_stop_paced_refresh(dev);
+  ssd1306_mirror_stop(dev);
+  if (device->lock) {
+    vSemaphoreDelete(device->lock);
+    vSemaphoreDelete(device->bus_lock);
+    free(&device->snapshot[0][0] - 1);
+  }
+  while (device->layers) {
+    ssd1306_layer_delete(device->layers);
+  }
+  while (device->widgets) {
+    ssd1306_widget_delete(device->widgets);
+  }
+  if (device->owns_shadow) {
+    free(device->shadow);
+  }
+  if (!device->is_static) {
+    free(device);
+  }
+}
+
+// Send the whole of tx_frame; called with the bus lock held.
+static esp_err_t ssd1306_send_frame(ssd1306_dev_t *device) {
+  esp_err_t ret;
+
+  if (device->refresh_mode == SSD1306_REFRESH_DIFF && device->shadow_valid) {
+    return ssd1306_refresh_diff(device);
+  }
+
+  // any bus policy needs the window path, which counts failures
+  if (device->bus.chunked || device->bus.retries || device->bus.reinit_after) {
+    const ssd1306_window_t full = {0, SSD1306_WIDTH - 1, 0, SSD1306_PAGES - 1};
+    if ((ret = ssd1306_flush_window(device, &full)) == ESP_OK) {
+      device->shadow_valid = device->shadow != NULL;
+    }
+    return ret;
+  }
+
+  if (!device->window_full) {
+    const ssd1306_window_t full = {0, SSD1306_WIDTH - 1, 0, SSD1306_PAGES - 1};
+    if ((ret = ssd1306_set_window(device, &full)) != ESP_OK) {
+      return ret;
+    }
+  }
+  // the frame is preceded by its data prefix byte: send it in place
+  ret = i2c_master_transmit(device->i2c_dev_handle,
+                            &device->tx_frame[0][0] - 1, 1 + SSD1306_FB_SIZE,
+                            device->bus.timeout_ms);
+  if (ret == ESP_OK && device->shadow) {
+    memcpy(device->shadow, device->tx_frame, SSD1306_FB_SIZE);
+    device->shadow_valid = true;
+  }
+  return ret;
+}
+
+// Start a refresh: take the device and bus locks, point tx_frame at what to
+// send and move the dirty marks to dirty. Once the device lock is given
+// up, drawing goes on during the transfer: with locking on, tx_frame is a
+// snapshot of the framebuffer.
+static void ssd1306_begin_refresh(ssd1306_dev_t *device, uint8_t *dirty) {
+  ssd1306_lock_bus(device);
+  if (device->snapshot) {
+    memcpy(device->snapshot, device->surface.fb, SSD1306_FB_SIZE);
+    device->tx_frame = device->snapshot;
+  } else {
+    device->tx_frame = device->surface.fb;
+  }
+  device->tx_mirror = !device->gray_subframe;
+  memcpy(dirty, device->dirty, sizeof(device->dirty));
+  memset(device->dirty, 0, sizeof(device->dirty));
+  device->gram_lost = false;
+}
+
+// Finish a refresh: resend everything if the panel was re-initialised part
+// way through, pass the frame to the mirror unless it is a gray subframe
+// and release the bus. A failed
+// refresh puts its dirty marks back.
+static esp_err_t ssd1306_end_refresh(ssd1306_dev_t *device,
+                                     const uint8_t *dirty, esp_err_t ret) {
+  if (ret == ESP_OK && device->gram_lost) {
+    device->gram_lost = false;
+    ret = ssd1306_send_frame(device);
+  }
+  if (ret == ESP_OK && device->mirror && device->tx_mirror) {
+    ssd1306_mirror_capture(device, device->tx_frame);
+  }
+  ssd1306_unlock_bus(device);
+
+  if (ret != ESP_OK) {
+    ssd1306_lock(device);
+    for (uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+      device->dirty[x] |= dirty[x];
+    }
+    ssd1306_unlock(device);
+  }
+  return ret;
+}
+
+esp_err_t ssd1306_refresh_and_unlock(ssd1306_dev_t *device) {
+  uint8_t dirty[SSD1306_WIDTH];
+
+  ssd1306_begin_refresh(device, dirty);
+  ssd1306_unlock(device); // ours
+  ssd1306_unlock(device); // the caller's
+  return ssd1306_end_refresh(device, dirty, ssd1306_send_frame(device));
+}
+
+esp_err_t ssd1306_refresh_frame_and_unlock(ssd1306_dev_t *device,
+                                          uint8_t (*frame)[SSD1306_PAGES]) {
+  uint8_t dirty[SSD1306_WIDTH];
+
+  if (frame != device->surface.fb) {
+    memcpy(device->surface.fb, frame, SSD1306_FB_SIZE);
+  }
+  device->tx_frame = frame;
+  device->tx_mirror = !device->gray_subframe;
+  // the whole frame goes out: if it fails, all of it is still to be sent
+  memset(dirty, 0xFF, sizeof(dirty));
+  memset(device->dirty, 0, sizeof(device->dirty));
+  device->gram_lost = false;
+  ssd1306_unlock(device);
+  return ssd1306_end_refresh(device, dirty, ssd1306_send_frame(device));
 }
 
 esp_err_t ssd1306_refresh_gram(ssd1306_handle_t dev) {
+  ssd1306_lock(dev);
+  return ssd1306_refresh_and_unlock((ssd1306_dev_t *)dev);
+}
+
+void ssd1306_set_clip(ssd1306_handle_t dev, uint8_t chXpos1, uint8_t chYpos1,
+                      uint8_t chXpos2, uint8_t chYpos2) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+  uint8_t temp;
+
+  if (surface->transposed) {
+    temp = chXpos1, chXpos1 = chYpos1, chYpos1 = temp;
+    temp = chXpos2, chXpos2 = chYpos2, chYpos2 = temp;
+  }
+  chXpos2 = MIN(chXpos2, surface->columns - 1);
+  chYpos2 = MIN(chYpos2, surface->rows - 1);
+  if (chXpos1 > chXpos2 || chYpos1 > chYpos2) {
+    // nothing left: an inverted range rejects every column and row
+    surface->clip_x1 = surface->clip_y1 = 1;
+    surface->clip_x2 = surface->clip_y2 = 0;
+    surface->clip_rows = 0;
+    return;
+  }
+  surface->clip_x1 = chXpos1;
+  surface->clip_y1 = chYpos1;
+  surface->clip_x2 = chXpos2;
+  surface->clip_y2 = chYpos2;
+  surface->clip_rows = ssd1306_row_mask(chYpos1, chYpos2);
+}
+
+void ssd1306_reset_clip(ssd1306_handle_t dev) {
+  ssd1306_surface_reset_clip((ssd1306_surface_t *)dev);
+}
+
+void ssd1306_mark_dirty(ssd1306_handle_t dev, uint8_t chXpos1,
+                        uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2) {
   ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
-  return ssd1306_write_data(dev, &device->s_chDisplayBuffer[0][0],
-                            sizeof(device->s_chDisplayBuffer));
+  uint8_t temp;
+
+  if (device->surface.transposed) {
+    temp = chXpos1, chXpos1 = chYpos1, chYpos1 = temp;
+    temp = chXpos2, chXpos2 = chYpos2, chYpos2 = temp;
+  }
+  if (chXpos1 > chXpos2 || chYpos1 > chYpos2 || chXpos1 >= SSD1306_WIDTH ||
+      chYpos1 >= SSD1306_HEIGHT) {
+    return;
+  }
+  chXpos2 = MIN(chXpos2, SSD1306_WIDTH - 1);
+  chYpos2 = MIN(chYpos2, SSD1306_HEIGHT - 1);
+
+  // rows y1..y2 are hardware pages 7 - y2 / 8 .. 7 - y1 / 8
+  uint8_t pages = (0xFF << (7 - chYpos2 / 8)) & (0xFF >> (chYpos1 / 8));
+  for (uint16_t x = chXpos1; x <= chXpos2; x++) {
+    device->dirty[x] |= pages;
+  }
 }
 
-void ssd1306_clear_screen(ssd1306_handle_t dev, uint8_t chFill) {
+esp_err_t ssd1306_refresh_dirty(ssd1306_handle_t dev) {
   ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
-  memset(device->s_chDisplayBuffer, chFill, sizeof(device->s_chDisplayBuffer));
+  uint8_t dirty[SSD1306_WIDTH], masks[SSD1306_WIDTH];
+  esp_err_t ret;
+
+  ssd1306_begin_refresh(device, dirty);
+  ssd1306_unlock(dev);
+  if (device->shadow && !device->shadow_valid) {
+    ret = ssd1306_send_frame(device); // panel contents unknown
+  } else {
+    // in DIFF mode, skip dirty pages that still match the panel
+    for (uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+      masks[x] = dirty[x];
+      if (masks[x] && device->shadow) {
+        masks[x] &= ssd1306_column_diff(device, x);
+      }
+    }
+    ret = ssd1306_refresh_windows(device, masks);
+  }
+  return ssd1306_end_refresh(device, dirty, ret);
+}
+
+void ssd1306_clear_screen(ssd1306_handle_t dev, uint8_t chFill) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+  memset(surface->fb, chFill, surface->columns * sizeof(surface->fb[0]));
 }
\ No newline at end of file
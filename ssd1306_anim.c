@@ -0,0 +1,214 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_anim.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+#define SSD1306_ANIM_HEADER 8
+#define SSD1306_ANIM_VERSION 1
+#define SSD1306_ANIM_FILE_BUF 64
+
+typedef struct {
+  ssd1306_dev_t *device;
+  ssd1306_rle_reader_t reader;
+  const uint8_t *buffer; // memory stream, NULL when playing from a file
+  size_t length;
+  FILE *file;
+  long file_start; // offset of the first frame in the file
+  uint8_t fps;
+  uint16_t frames;
+  uint16_t frame; // index of the next frame
+  uint8_t file_buf[SSD1306_ANIM_FILE_BUF];
+} ssd1306_anim_t;
+
+static bool ssd1306_anim_refill(ssd1306_rle_reader_t *reader) {
+  ssd1306_anim_t *anim = (ssd1306_anim_t *)reader->ctx;
+  size_t len = fread(anim->file_buf, 1, sizeof(anim->file_buf), anim->file);
+
+  reader->src = anim->file_buf;
+  reader->len = len;
+  return len > 0;
+}
+
+static void ssd1306_anim_reset_reader(ssd1306_anim_t *anim) {
+  memset(&anim->reader, 0, sizeof(anim->reader));
+  if (anim->file) {
+    anim->reader.refill = ssd1306_anim_refill;
+    anim->reader.ctx = anim;
+  } else {
+    anim->reader.src = anim->buffer + SSD1306_ANIM_HEADER;
+    anim->reader.len = anim->length - SSD1306_ANIM_HEADER;
+  }
+  anim->frame = 0;
+}
+
+static ssd1306_anim_t *ssd1306_anim_open(ssd1306_handle_t dev,
+                                         const uint8_t *header) {
+  ssd1306_anim_t *anim;
+
+  if (header[0] != 'S' || header[1] != 'A' ||
+      header[2] != SSD1306_ANIM_VERSION || !header[3]) {
+    return NULL;
+  }
+  if (!(anim = calloc(1, sizeof(ssd1306_anim_t)))) {
+    return NULL;
+  }
+  anim->device = (ssd1306_dev_t *)dev;
+  anim->fps = header[3];
+  anim->frames = header[4] | header[5] << 8;
+  return anim;
+}
+
+ssd1306_anim_handle_t ssd1306_anim_open_buffer(ssd1306_handle_t dev,
+                                               const void *buffer,
+                                               size_t length) {
+  ssd1306_anim_t *anim;
+
+  if (length < SSD1306_ANIM_HEADER ||
+      !(anim = ssd1306_anim_open(dev, (const uint8_t *)buffer))) {
+    return NULL;
+  }
+  anim->buffer = (const uint8_t *)buffer;
+  anim->length = length;
+  ssd1306_anim_reset_reader(anim);
+  return (ssd1306_anim_handle_t)anim;
+}
+
+ssd1306_anim_handle_t ssd1306_anim_open_file(ssd1306_handle_t dev,
+                                             FILE *file) {
+  uint8_t header[SSD1306_ANIM_HEADER];
+  ssd1306_anim_t *anim;
+
+  if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+      !(anim = ssd1306_anim_open(dev, header))) {
+    return NULL;
+  }
+  anim->file = file;
+  anim->file_start = ftell(file);
+  ssd1306_anim_reset_reader(anim);
+  return (ssd1306_anim_handle_t)anim;
+}
+
+void ssd1306_anim_close(ssd1306_anim_handle_t handle) {
+  free(handle);
+}
+
+uint8_t ssd1306_anim_get_fps(ssd1306_anim_handle_t handle) {
+  return ((ssd1306_anim_t *)handle)->fps;
+}
+
+esp_err_t ssd1306_anim_rewind(ssd1306_anim_handle_t handle) {
+  ssd1306_anim_t *anim = (ssd1306_anim_t *)handle;
+
+  if (anim->file && fseek(anim->file, anim->file_start, SEEK_SET)) {
+    return ESP_FAIL;
+  }
+  ssd1306_anim_reset_reader(anim);
+  return ESP_OK;
+}
+
+// Decode one window into the framebuffer and send it with the bus policy,
+// which also brings the shadow up to date.
+static esp_err_t ssd1306_anim_window(ssd1306_anim_t *anim,
+                                     const ssd1306_window_t *win) {
+  ssd1306_dev_t *device = anim->device;
+  uint8_t pages = win->p1 - win->p0 + 1;
+
+  for (uint16_t x = win->c0; x <= win->c1; x++) {
+    if (!ssd1306_rle_read(&anim->reader, &device->surface.fb[x][win->p0],
+                          pages)) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+  }
+  return ssd1306_send_fb_window(device, win);
+}
+
+esp_err_t ssd1306_anim_next_frame(ssd1306_anim_handle_t handle) {
+  ssd1306_anim_t *anim = (ssd1306_anim_t *)handle;
+  ssd1306_dev_t *device = anim->device;
+  const ssd1306_window_t full = {0, SSD1306_WIDTH - 1, 0, SSD1306_PAGES - 1};
+  ssd1306_rle_reader_t start = anim->reader; // frames start between opcodes
+  long start_pos = anim->file ? ftell(anim->file) : 0;
+  uint8_t count, coords[4];
+  ssd1306_window_t win;
+  esp_err_t ret = ESP_OK;
+
+  if (anim->frame >= anim->frames) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  // the frame is decoded into the framebuffer and sent window by window
+  ssd1306_lock_bus(device);
+  if (!ssd1306_rle_read_raw(&anim->reader, &count, 1)) {
+    ret = ESP_ERR_INVALID_SIZE;
+    count = 0;
+  }
+  while (count--) {
+    if (!ssd1306_rle_read_raw(&anim->reader, coords, sizeof(coords))) {
+      ret = ESP_ERR_INVALID_SIZE;
+      break;
+    }
+    win = (ssd1306_window_t){coords[0], coords[1], coords[2], coords[3]};
+    if (win.c0 > win.c1 || win.c1 >= SSD1306_WIDTH || win.p0 > win.p1 ||
+        win.p1 >= SSD1306_PAGES) {
+      ret = ESP_ERR_INVALID_SIZE;
+      break;
+    }
+    if ((ret = ssd1306_anim_window(anim, &win)) != ESP_OK) {
+      // chunks sent before the failure are ahead of the shadow
+      device->shadow_valid = false;
+      break;
+    }
+  }
+  // a recovery re-initialised the panel during this frame or a failed one
+  // before it: earlier windows went to a GRAM since cleared, so send the
+  // whole frame
+  if (ret == ESP_OK && device->gram_lost) {
+    device->gram_lost = false;
+    if ((ret = ssd1306_send_fb_window(device, &full)) == ESP_OK) {
+      device->shadow_valid = device->shadow != NULL;
+    }
+  }
+  if (ret == ESP_OK && device->mirror) {
+    ssd1306_mirror_capture(device, device->surface.fb);
+  }
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(device);
+
+  if (ret == ESP_OK) {
+    anim->frame++;
+    return ESP_OK;
+  }
+  // back to the start of the frame, so the next call decodes it again
+  // rather than reading window data as a window header
+  anim->reader = start;
+  if (anim->file) {
+    anim->reader.len = 0; // file_buf is refilled from the seek
+    fseek(anim->file, start_pos - (long)start.len, SEEK_SET);
+  }
+  return ret;
+}
+
+esp_err_t ssd1306_anim_play(ssd1306_anim_handle_t handle, uint16_t count) {
+  ssd1306_anim_t *anim = (ssd1306_anim_t *)handle;
+  TickType_t period = MAX(pdMS_TO_TICKS(1000 / anim->fps), 1);
+  TickType_t wake = xTaskGetTickCount();
+  esp_err_t ret;
+
+  while (count--) {
+    if ((ret = ssd1306_anim_rewind(anim)) != ESP_OK) {
+      return ret;
+    }
+    while ((ret = ssd1306_anim_next_frame(anim)) == ESP_OK) {
+      xTaskDelayUntil(&wake, period);
+    }
+    if (ret != ESP_ERR_NOT_FOUND) {
+      return ret;
+    }
+  }
+  return ESP_OK;
+}
@@ -0,0 +1,170 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_canvas.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+typedef struct {
+  ssd1306_surface_t surface; // must stay first
+  bool owns_buffer;
+} ssd1306_canvas_t;
+
+ssd1306_canvas_handle_t ssd1306_canvas_create_with_buffer(uint8_t *pchBuffer,
+                                                          uint8_t chWidth,
+                                                          uint8_t chHeight) {
+  ssd1306_canvas_t *canvas;
+
+  if (!pchBuffer || !chWidth || !chHeight || chHeight > SSD1306_HEIGHT) {
+    return NULL;
+  }
+  canvas = calloc(1, sizeof(ssd1306_canvas_t));
+  if (!canvas) {
+    return NULL;
+  }
+  canvas->surface.fb = (uint8_t(*)[SSD1306_PAGES])pchBuffer;
+  canvas->surface.columns = canvas->surface.width = chWidth;
+  canvas->surface.rows = canvas->surface.height = chHeight;
+  ssd1306_surface_reset_clip(&canvas->surface);
+
+  return (ssd1306_canvas_handle_t)canvas;
+}
+
+ssd1306_canvas_handle_t ssd1306_canvas_create(uint8_t chWidth,
+                                              uint8_t chHeight) {
+  ssd1306_canvas_t *canvas;
+  uint8_t *buffer;
+
+  if (!chWidth || !chHeight || chHeight > SSD1306_HEIGHT) {
+    return NULL;
+  }
+  buffer = calloc(1, SSD1306_CANVAS_BUFFER_SIZE(chWidth));
+  if (!buffer) {
+    return NULL;
+  }
+  canvas = ssd1306_canvas_create_with_buffer(buffer, chWidth, chHeight);
+  if (!canvas) {
+    free(buffer);
+    return NULL;
+  }
+  canvas->owns_buffer = true;
+
+  return (ssd1306_canvas_handle_t)canvas;
+}
+
+void ssd1306_canvas_delete(ssd1306_canvas_handle_t canvas) {
+  ssd1306_canvas_t *c = (ssd1306_canvas_t *)canvas;
+
+  if (c->owns_buffer) {
+    free(c->surface.fb);
+  }
+  free(c);
+}
+
+void ssd1306_canvas_set_font(ssd1306_canvas_handle_t canvas,
+                             ssd1306_handle_t src) {
+  ((ssd1306_surface_t *)canvas)->bdf_font =
+      ((ssd1306_surface_t *)src)->bdf_font;
+}
+
+void ssd1306_blit(ssd1306_handle_t dst, int16_t x, int16_t y,
+                  ssd1306_canvas_handle_t src) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)src;
+
+  ssd1306_blit_region(dst, x, y, src, 0, 0, surface->columns, surface->rows);
+}
+
+// Each source column is one word: landscape targets take it with a single
+// shift and masked store per column. Portrait targets need the rectangle
+// transposed, which is done in 8x8 tiles with ssd1306_transpose8 before one
+// masked store per panel column.
+void ssd1306_blit_region(ssd1306_handle_t dst, int16_t x, int16_t y,
+                         ssd1306_canvas_handle_t src, uint8_t chSrcX,
+                         uint8_t chSrcY, uint8_t chWidth, uint8_t chHeight) {
+  ssd1306_surface_t *to = (ssd1306_surface_t *)dst;
+  const ssd1306_surface_t *from = (const ssd1306_surface_t *)src;
+  int16_t w, h;
+
+  if (chSrcX >= from->columns || chSrcY >= from->rows) {
+    return;
+  }
+  w = MIN(chWidth, from->columns - chSrcX);
+  h = MIN(chHeight, from->rows - chSrcY);
+
+  // clip against the destination's drawing area
+  if (x < 0) {
+    w += x;
+    chSrcX -= x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    chSrcY -= y;
+    y = 0;
+  }
+  w = MIN(w, to->width - x);
+  h = MIN(h, to->height - y);
+  if (w <= 0 || h <= 0) {
+    return;
+  }
+
+  uint64_t src_mask = ssd1306_row_mask(chSrcY, chSrcY + h - 1);
+
+  if (!to->transposed) {
+    int16_t dy = y - chSrcY;
+    uint64_t dst_mask = ssd1306_column_shift(src_mask, dy) & to->clip_rows;
+    for (int16_t i = 0; i < w; i++) {
+      if (!ssd1306_clip_column(to, x + i)) {
+        continue;
+      }
+      uint8_t *col = to->fb[x + i];
+      uint64_t word = ssd1306_column_shift(
+          ssd1306_column_load(from->fb[chSrcX + i]) & src_mask, dy);
+      word &= dst_mask;
+      ssd1306_column_store(col, (ssd1306_column_load(col) & ~dst_mask) | word);
+    }
+    return;
+  }
+
+  // source columns land on panel rows x.., source rows on panel columns y..
+  uint64_t cols[SSD1306_HEIGHT];
+  uint64_t dst_mask = ssd1306_row_mask(x, x + w - 1) & to->clip_rows;
+  for (int16_t i = 0; i < w; i++) {
+    // source row chSrcY + j ends up in bit 63 - j
+    cols[i] = (ssd1306_column_load(from->fb[chSrcX + i]) & src_mask)
+              << chSrcY;
+  }
+  for (int16_t i = w; i < ((w + 7) & ~7); i++) {
+    cols[i] = 0; // pad the last tile
+  }
+  for (int16_t j0 = 0; j0 < h; j0 += 8) {
+    uint64_t words[8] = {0};
+    for (int16_t i0 = 0; i0 < w; i0 += 8) {
+      // tile rows are source columns i0.., tile columns source rows j0..
+      uint64_t tile = 0;
+      for (uint8_t k = 0; k < 8; k++) {
+        tile |= (cols[i0 + k] >> (56 - j0) & 0xFF) << (56 - 8 * k);
+      }
+      if (!tile) {
+        continue;
+      }
+      tile = ssd1306_transpose8(tile);
+      for (uint8_t k = 0; k < 8; k++) {
+        // row j0 + k of the tile, source column i0 first, at panel row x + i0
+        words[k] |= ssd1306_column_shift(tile << 8 * k & 0xFF00000000000000ULL,
+                                         x + i0);
+      }
+    }
+    for (int16_t k = 0; k < 8 && j0 + k < h; k++) {
+      if (!ssd1306_clip_column(to, y + j0 + k)) {
+        continue;
+      }
+      uint8_t *col = to->fb[y + j0 + k];
+      ssd1306_column_store(col, (ssd1306_column_load(col) & ~dst_mask) |
+                                    (words[k] & dst_mask));
+    }
+  }
+}
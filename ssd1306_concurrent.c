@@ -0,0 +1,295 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_concurrent.h"
+#include "freertos/semphr.h"
+#include "ssd1306_canvas.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+// Bounded multi-producer queue after Dmitry Vyukov's MPMC design. Each slot
+// carries a sequence number telling producers and the consumer whose turn it
+// is, so producers only contend on one compare-and-swap of enqueue_pos and
+// never wait on a lock. There is a single consumer, the render task.
+typedef struct {
+  atomic_uint seq;
+  ssd1306_cmd_t cmd;
+} ssd1306_cmd_slot_t;
+
+struct ssd1306_cmd_queue {
+  ssd1306_cmd_slot_t *slots;
+  unsigned int mask;
+  atomic_uint enqueue_pos;
+  unsigned int dequeue_pos; // render task only
+};
+
+static bool ssd1306_queue_push(ssd1306_cmd_queue_t *queue,
+                               const ssd1306_cmd_t *cmd) {
+  unsigned int pos =
+      atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  ssd1306_cmd_slot_t *slot;
+
+  for (;;) {
+    slot = &queue->slots[pos & queue->mask];
+    unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    int diff = (int)(seq - pos);
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos,
+                                                pos + 1, memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false; // full
+    } else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+
+  slot->cmd = *cmd;
+  atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+  return true;
+}
+
+static bool ssd1306_queue_pop(ssd1306_cmd_queue_t *queue, ssd1306_cmd_t *cmd) {
+  unsigned int pos = queue->dequeue_pos;
+  ssd1306_cmd_slot_t *slot = &queue->slots[pos & queue->mask];
+
+  if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1) {
+    return false; // empty, or the producer is still copying
+  }
+  *cmd = slot->cmd;
+  atomic_store_explicit(&slot->seq, pos + queue->mask + 1,
+                        memory_order_release);
+  queue->dequeue_pos = pos + 1;
+  return true;
+}
+
+void ssd1306_apply_command(ssd1306_handle_t dev, const ssd1306_cmd_t *cmd) {
+  ssd1306_surface_t *device = (ssd1306_surface_t *)dev;
+
+  switch (cmd->type) {
+  case SSD1306_CMD_FILL_POINT:
+    ssd1306_fill_point(device, cmd->point.x, cmd->point.y, cmd->point.on);
+    break;
+  case SSD1306_CMD_FILL_RECTANGLE:
+    ssd1306_fill_rectangle(device, cmd->rect.x1, cmd->rect.y1, cmd->rect.x2,
+                           cmd->rect.y2, cmd->rect.on);
+    break;
+  case SSD1306_CMD_DRAW_LINE:
+    ssd1306_draw_line(device, cmd->line.x1, cmd->line.y1, cmd->line.x2,
+                      cmd->line.y2);
+    break;
+  case SSD1306_CMD_DRAW_BITMAP:
+    ssd1306_draw_bitmap(device, cmd->bitmap.x, cmd->bitmap.y,
+                        cmd->bitmap.data, cmd->bitmap.width,
+                        cmd->bitmap.height);
+    break;
+  case SSD1306_CMD_DRAW_TEXT:
+    if (device->bdf_font) {
+      ssd1306_draw_bdf_text(device, cmd->text.x, cmd->text.y, cmd->text.text);
+    }
+    break;
+  case SSD1306_CMD_CLEAR:
+    ssd1306_clear_screen(device, cmd->clear.fill);
+    break;
+  case SSD1306_CMD_BLIT:
+    ssd1306_blit(device, cmd->blit.x, cmd->blit.y,
+                 (ssd1306_canvas_handle_t)cmd->blit.canvas);
+    break;
+  case SSD1306_CMD_REFRESH:
+    break; // handled by the render task
+  }
+}
+
+static void ssd1306_render_task(void *arg) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)arg;
+  ssd1306_cmd_t cmd;
+
+  for (;;) {
+    bool run = atomic_load(&device->render_run);
+    bool refresh = false, drew = false;
+
+    ssd1306_lock(device);
+    while (ssd1306_queue_pop(device->queue, &cmd)) {
+      if (cmd.type == SSD1306_CMD_REFRESH) {
+        refresh = true;
+      } else {
+        ssd1306_apply_command(device, &cmd);
+        drew = true;
+      }
+    }
+    ssd1306_unlock(device);
+
+    // outside the lock: the refresh only holds it to take its snapshot
+    if (refresh || (drew && device->auto_refresh)) {
+      if (device->pacer_task) {
+        ssd1306_request_refresh(device);
+      } else {
+        ssd1306_refresh_gram(device);
+      }
+    }
+
+    if (!run) {
+      break;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+
+  xTaskNotifyGive(device->render_waiter);
+  vTaskDelete(NULL);
+}
+
+esp_err_t ssd1306_concurrent_start(ssd1306_handle_t dev,
+                                   const ssd1306_concurrent_config_t *config) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_cmd_queue_t *queue;
+  unsigned int len = 1;
+
+  if (!config->queue_len) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (device->render_task) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  while (len < config->queue_len) {
+    len <<= 1;
+  }
+
+  if (ssd1306_lock_create(device) != ESP_OK) {
+    return ESP_ERR_NO_MEM;
+  }
+  queue = calloc(1, sizeof(ssd1306_cmd_queue_t));
+  if (!queue || !(queue->slots = calloc(len, sizeof(ssd1306_cmd_slot_t)))) {
+    free(queue);
+    return ESP_ERR_NO_MEM;
+  }
+  queue->mask = len - 1;
+  for (unsigned int i = 0; i < len; i++) {
+    atomic_init(&queue->slots[i].seq, i);
+  }
+  atomic_init(&queue->enqueue_pos, 0);
+
+  device->queue = queue;
+  device->auto_refresh = config->auto_refresh;
+  atomic_store(&device->render_run, true);
+  if (xTaskCreatePinnedToCore(ssd1306_render_task, "ssd1306_render",
+                              config->task_stack, device,
+                              config->task_priority, &device->render_task,
+                              config->task_core) != pdPASS) {
+    device->render_task = NULL;
+    device->queue = NULL;
+    free(queue->slots);
+    free(queue);
+    return ESP_ERR_NO_MEM;
+  }
+  atomic_fetch_or(&device->post_state, SSD1306_POST_OPEN);
+
+  return ESP_OK;
+}
+
+void ssd1306_concurrent_stop(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_cmd_queue_t *queue = device->queue;
+
+  // close the queue, then wait for producers already inside to finish, so
+  // every accepted command is drawn and none lands in freed slots
+  if (!(atomic_fetch_and(&device->post_state, ~SSD1306_POST_OPEN) &
+        SSD1306_POST_OPEN)) {
+    return;
+  }
+  while (atomic_load(&device->post_state)) {
+    vTaskDelay(1);
+  }
+
+  // the task reads render_waiter once it sees render_run cleared
+  device->render_waiter = xTaskGetCurrentTaskHandle();
+  atomic_store(&device->render_run, false);
+  xTaskNotifyGive(device->render_task);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  device->render_task = NULL;
+  device->queue = NULL;
+  free(queue->slots);
+  free(queue);
+}
+
+esp_err_t ssd1306_post_command(ssd1306_handle_t dev,
+                               const ssd1306_cmd_t *cmd) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  esp_err_t ret = ESP_OK;
+
+  if (!(atomic_fetch_add(&device->post_state, 1) & SSD1306_POST_OPEN)) {
+    ret = ESP_ERR_INVALID_STATE; // not started, or stopping
+  } else if (!ssd1306_queue_push(device->queue, cmd)) {
+    ret = ESP_ERR_NO_MEM;
+  } else {
+    xTaskNotifyGive(device->render_task);
+  }
+  atomic_fetch_sub(&device->post_state, 1);
+  return ret;
+}
+
+esp_err_t ssd1306_lock_create(ssd1306_dev_t *device) {
+  uint8_t *snapshot;
+
+  if (device->lock) {
+    return ESP_OK;
+  }
+  if (!(snapshot = malloc(1 + SSD1306_FB_SIZE))) {
+    return ESP_ERR_NO_MEM;
+  }
+  if (!(device->bus_lock = xSemaphoreCreateMutex())) {
+    free(snapshot);
+    return ESP_ERR_NO_MEM;
+  }
+  if (!(device->lock = xSemaphoreCreateRecursiveMutex())) {
+    vSemaphoreDelete(device->bus_lock);
+    device->bus_lock = NULL;
+    free(snapshot);
+    return ESP_ERR_NO_MEM;
+  }
+  // preceded by the data prefix, like the framebuffer, to be sent in place
+  snapshot[0] = SSD1306_WRITE_DAT;
+  device->snapshot = (uint8_t(*)[SSD1306_PAGES])(snapshot + 1);
+  return ESP_OK;
+}
+
+void ssd1306_lock_bus(ssd1306_dev_t *device) {
+  for (;;) {
+    ssd1306_lock(device);
+    if (!device->bus_lock ||
+        xSemaphoreTake(device->bus_lock, 0) == pdTRUE) {
+      return;
+    }
+    ssd1306_unlock(device);
+    // wait for the transfer in flight without holding up drawing
+    xSemaphoreTake(device->bus_lock, portMAX_DELAY);
+    xSemaphoreGive(device->bus_lock);
+  }
+}
+
+void ssd1306_unlock_bus(ssd1306_dev_t *device) {
+  if (device->bus_lock) {
+    xSemaphoreGive(device->bus_lock);
+  }
+}
+
+void ssd1306_lock(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (device->lock) {
+    xSemaphoreTakeRecursive(device->lock, portMAX_DELAY);
+  }
+}
+
+void ssd1306_unlock(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  if (device->lock) {
+    xSemaphoreGiveRecursive(device->lock);
+  }
+}
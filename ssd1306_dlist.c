@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_dlist.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+// Opaque areas remembered while looking for occluded commands; when full,
+// the smallest gives way to a larger one.
+#define SSD1306_DLIST_OCCLUDERS 8
+
+typedef struct {
+  uint16_t capacity;
+  uint16_t count;
+  bool compiled; // occluded[] is up to date
+  ssd1306_dlist_stats_t stats;
+  ssd1306_cmd_t *cmds;
+  ssd1306_rect_t *bounds; // area each command may touch, drawing coordinates
+  bool *occluded;
+} ssd1306_dlist_t;
+
+static const ssd1306_rect_t ssd1306_dlist_everything = {0, 0, UINT8_MAX,
+                                                        UINT8_MAX};
+
+// Area a command may write to, and whether it overwrites all of it.
+static bool ssd1306_dlist_bounds(const ssd1306_cmd_t *cmd,
+                                 ssd1306_rect_t *rect) {
+  const ssd1306_surface_t *canvas;
+
+  switch (cmd->type) {
+  case SSD1306_CMD_FILL_POINT:
+    *rect = (ssd1306_rect_t){cmd->point.x, cmd->point.y, cmd->point.x,
+                             cmd->point.y};
+    return false;
+  case SSD1306_CMD_FILL_RECTANGLE:
+    *rect = (ssd1306_rect_t){cmd->rect.x1, cmd->rect.y1, cmd->rect.x2,
+                             cmd->rect.y2};
+    return true;
+  case SSD1306_CMD_DRAW_LINE:
+    *rect = (ssd1306_rect_t){MIN(cmd->line.x1, cmd->line.x2),
+                             MIN(cmd->line.y1, cmd->line.y2),
+                             MAX(cmd->line.x1, cmd->line.x2),
+                             MAX(cmd->line.y1, cmd->line.y2)};
+    if (rect->x1 < 0 || rect->y1 < 0 || rect->x2 > UINT8_MAX ||
+        rect->y2 > UINT8_MAX) {
+      *rect = ssd1306_dlist_everything; // wraps around
+    }
+    return false;
+  case SSD1306_CMD_DRAW_BITMAP:
+    *rect = (ssd1306_rect_t){cmd->bitmap.x, cmd->bitmap.y,
+                             cmd->bitmap.x + cmd->bitmap.width - 1,
+                             cmd->bitmap.y + cmd->bitmap.height - 1};
+    return false; // ORed onto the frame
+  case SSD1306_CMD_BLIT:
+    canvas = (const ssd1306_surface_t *)cmd->blit.canvas;
+    *rect = (ssd1306_rect_t){cmd->blit.x, cmd->blit.y,
+                             cmd->blit.x + canvas->width - 1,
+                             cmd->blit.y + canvas->height - 1};
+    return true;
+  case SSD1306_CMD_DRAW_TEXT:
+    *rect = ssd1306_dlist_everything;
+    return false;
+  case SSD1306_CMD_CLEAR:
+    *rect = ssd1306_dlist_everything;
+    return true;
+  case SSD1306_CMD_REFRESH:
+  default:
+    *rect = (ssd1306_rect_t){1, 1, 0, 0}; // draws nothing
+    return false;
+  }
+}
+
+static bool ssd1306_rect_contains(const ssd1306_rect_t *outer,
+                                  const ssd1306_rect_t *inner) {
+  return outer->x1 <= inner->x1 && outer->y1 <= inner->y1 &&
+         outer->x2 >= inner->x2 && outer->y2 >= inner->y2;
+}
+
+static int32_t ssd1306_rect_area(const ssd1306_rect_t *rect) {
+  return (int32_t)(rect->x2 - rect->x1 + 1) * (rect->y2 - rect->y1 + 1);
+}
+
+// Walk the list backwards, collecting opaque areas: a command inside one of
+// them is overwritten by a later command and need not be drawn.
+static void ssd1306_dlist_compile(ssd1306_dlist_t *dl) {
+  ssd1306_rect_t occluders[SSD1306_DLIST_OCCLUDERS];
+  uint8_t count = 0, smallest;
+  ssd1306_rect_t rect;
+
+  for (int i = dl->count - 1; i >= 0; i--) {
+    dl->occluded[i] = false;
+    // a clear ignores the clip, so later commands drawn under a clip may not
+    // cover all of it: it is never skipped
+    for (uint8_t k = 0; k < count && dl->cmds[i].type != SSD1306_CMD_CLEAR;
+         k++) {
+      if (ssd1306_rect_contains(&occluders[k], &dl->bounds[i])) {
+        dl->occluded[i] = true;
+        break;
+      }
+    }
+    if (dl->occluded[i] || !ssd1306_dlist_bounds(&dl->cmds[i], &rect) ||
+        rect.x1 > rect.x2 || rect.y1 > rect.y2) {
+      continue;
+    }
+    if (count < SSD1306_DLIST_OCCLUDERS) {
+      occluders[count++] = rect;
+      continue;
+    }
+    smallest = 0;
+    for (uint8_t k = 1; k < count; k++) {
+      if (ssd1306_rect_area(&occluders[k]) <
+          ssd1306_rect_area(&occluders[smallest])) {
+        smallest = k;
+      }
+    }
+    if (ssd1306_rect_area(&rect) > ssd1306_rect_area(&occluders[smallest])) {
+      occluders[smallest] = rect;
+    }
+  }
+  dl->compiled = true;
+}
+
+ssd1306_dlist_handle_t ssd1306_dlist_create(uint16_t capacity) {
+  ssd1306_dlist_t *dl;
+
+  if (!capacity) {
+    return NULL;
+  }
+  // one block: header, commands, bounds, flags
+  dl = calloc(1, sizeof(ssd1306_dlist_t) +
+                     capacity * (sizeof(ssd1306_cmd_t) +
+                                 sizeof(ssd1306_rect_t) + sizeof(bool)));
+  if (!dl) {
+    return NULL;
+  }
+  dl->capacity = capacity;
+  dl->cmds = (ssd1306_cmd_t *)(dl + 1);
+  dl->bounds = (ssd1306_rect_t *)(dl->cmds + capacity);
+  dl->occluded = (bool *)(dl->bounds + capacity);
+
+  return (ssd1306_dlist_handle_t)dl;
+}
+
+void ssd1306_dlist_delete(ssd1306_dlist_handle_t dlist) { free(dlist); }
+
+void ssd1306_dlist_reset(ssd1306_dlist_handle_t dlist) {
+  ssd1306_dlist_t *dl = (ssd1306_dlist_t *)dlist;
+
+  dl->count = 0;
+  dl->compiled = false;
+}
+
+esp_err_t ssd1306_dlist_add(ssd1306_dlist_handle_t dlist,
+                            const ssd1306_cmd_t *cmd) {
+  ssd1306_dlist_t *dl = (ssd1306_dlist_t *)dlist;
+
+  if (dl->count == dl->capacity) {
+    return ESP_ERR_NO_MEM;
+  }
+  dl->cmds[dl->count] = *cmd;
+  ssd1306_dlist_bounds(cmd, &dl->bounds[dl->count]);
+  dl->count++;
+  dl->compiled = false;
+
+  return ESP_OK;
+}
+
+void ssd1306_dlist_execute(ssd1306_handle_t dev, ssd1306_dlist_handle_t dlist) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+  ssd1306_dlist_t *dl = (ssd1306_dlist_t *)dlist;
+  ssd1306_rect_t clip;
+
+  if (!dl->compiled) {
+    ssd1306_dlist_compile(dl);
+  }
+  // the clip is kept in panel coordinates
+  if (surface->transposed) {
+    clip = (ssd1306_rect_t){surface->clip_y1, surface->clip_x1,
+                            surface->clip_y2, surface->clip_x2};
+  } else {
+    clip = (ssd1306_rect_t){surface->clip_x1, surface->clip_y1,
+                            surface->clip_x2, surface->clip_y2};
+  }
+
+  memset(&dl->stats, 0, sizeof(dl->stats));
+  dl->stats.commands = dl->count;
+  for (uint16_t i = 0; i < dl->count; i++) {
+    const ssd1306_rect_t *rect = &dl->bounds[i];
+
+    if (dl->occluded[i]) {
+      dl->stats.occluded++;
+    } else if (dl->cmds[i].type != SSD1306_CMD_CLEAR &&
+               (rect->x1 > clip.x2 || rect->x2 < clip.x1 ||
+                rect->y1 > clip.y2 || rect->y2 < clip.y1 ||
+                rect->x1 > rect->x2 || rect->y1 > rect->y2)) {
+      dl->stats.clipped++; // ssd1306_clear_screen alone ignores the clip
+    } else {
+      ssd1306_apply_command(dev, &dl->cmds[i]);
+    }
+  }
+}
+
+void ssd1306_dlist_get_stats(ssd1306_dlist_handle_t dlist,
+                             ssd1306_dlist_stats_t *stats) {
+  *stats = ((ssd1306_dlist_t *)dlist)->stats;
+}
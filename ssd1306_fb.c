@@ -0,0 +1,316 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Framebuffer-wide and region operations. Each column is handled as one
+// 64-bit word (see ssd1306_priv.h), so a region is a row mask applied across
+// its columns and any vertical shift is a single word shift.
+
+#include "ssd1306_priv.h"
+#include <stddef.h>
+
+#define SSD1306_SWAP(a, b)                                                     \
+  do {                                                                         \
+    __typeof__(a) swap_tmp = (a);                                              \
+    (a) = (b);                                                                 \
+    (b) = swap_tmp;                                                            \
+  } while (0)
+
+// Map a rectangle from drawing to panel coordinates and clip it to the
+// surface bounds; false if nothing is left.
+static bool ssd1306_bound_rect(const ssd1306_surface_t *surface, uint8_t *x1,
+                               uint8_t *y1, uint8_t *x2, uint8_t *y2) {
+  if (surface->transposed) {
+    SSD1306_SWAP(*x1, *y1);
+    SSD1306_SWAP(*x2, *y2);
+  }
+  if (*x1 > *x2 || *y1 > *y2 || *x1 >= surface->columns ||
+      *y1 >= surface->rows) {
+    return false;
+  }
+  *x2 = MIN(*x2, surface->columns - 1);
+  *y2 = MIN(*y2, surface->rows - 1);
+  return true;
+}
+
+// Same, clipping to the drawing clip instead.
+static bool ssd1306_clip_rect(const ssd1306_surface_t *surface, uint8_t *x1,
+                              uint8_t *y1, uint8_t *x2, uint8_t *y2) {
+  if (!ssd1306_bound_rect(surface, x1, y1, x2, y2) ||
+      *x1 > surface->clip_x2 || *x2 < surface->clip_x1 ||
+      *y1 > surface->clip_y2 || *y2 < surface->clip_y1) {
+    return false;
+  }
+  *x1 = MAX(*x1, surface->clip_x1);
+  *y1 = MAX(*y1, surface->clip_y1);
+  *x2 = MIN(*x2, surface->clip_x2);
+  *y2 = MIN(*y2, surface->clip_y2);
+  return true;
+}
+
+void ssd1306_invert_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                           uint8_t chYpos1, uint8_t chXpos2,
+                           uint8_t chYpos2) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  if (!ssd1306_clip_rect(surface, &chXpos1, &chYpos1, &chXpos2, &chYpos2)) {
+    return;
+  }
+  uint64_t mask = ssd1306_row_mask(chYpos1, chYpos2);
+  for (uint8_t x = chXpos1; x <= chXpos2; x++) {
+    uint8_t *col = surface->fb[x];
+    ssd1306_column_store(col, ssd1306_column_load(col) ^ mask);
+  }
+}
+
+void ssd1306_xor_pattern(ssd1306_handle_t dev, uint8_t chXpos1,
+                         uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                         const uint8_t *pchPattern, uint8_t chPatternLen) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  if (!chPatternLen ||
+      !ssd1306_clip_rect(surface, &chXpos1, &chYpos1, &chXpos2, &chYpos2)) {
+    return;
+  }
+  uint64_t mask = ssd1306_row_mask(chYpos1, chYpos2);
+  for (uint8_t x = chXpos1; x <= chXpos2; x++) {
+    // the same byte in every page repeats the pattern down the column
+    uint64_t pattern = pchPattern[x % chPatternLen] * 0x0101010101010101ULL;
+    uint8_t *col = surface->fb[x];
+    ssd1306_column_store(col, ssd1306_column_load(col) ^ (pattern & mask));
+  }
+}
+
+void ssd1306_scroll_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                           uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                           int16_t dx, int16_t dy, uint8_t chFill) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  if (!ssd1306_clip_rect(surface, &chXpos1, &chYpos1, &chXpos2, &chYpos2)) {
+    return;
+  }
+  if (surface->transposed) {
+    SSD1306_SWAP(dx, dy);
+  }
+  uint64_t mask = ssd1306_row_mask(chYpos1, chYpos2);
+  uint64_t vacated = chFill ? mask & ~ssd1306_column_shift(mask, dy) : 0;
+  int16_t width = chXpos2 - chXpos1 + 1;
+
+  // walk against the direction of travel so sources are read before they
+  // are overwritten
+  for (int16_t i = 0; i < width; i++) {
+    int16_t x = dx > 0 ? chXpos2 - i : chXpos1 + i;
+    int16_t src = x - dx;
+    uint8_t *col = surface->fb[x];
+    uint64_t word = ssd1306_column_load(col) & ~mask;
+
+    if (src >= chXpos1 && src <= chXpos2) {
+      uint64_t moved = ssd1306_column_load(surface->fb[src]) & mask;
+      word |= (ssd1306_column_shift(moved, dy) & mask) | vacated;
+    } else if (chFill) {
+      word |= mask;
+    }
+    ssd1306_column_store(col, word);
+  }
+}
+
+void ssd1306_scroll(ssd1306_handle_t dev, int16_t dx, int16_t dy,
+                    uint8_t chFill) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  ssd1306_scroll_region(dev, 0, 0, surface->width - 1, surface->height - 1, dx,
+                        dy, chFill);
+}
+
+// Copy with the rectangle already clipped and everything in panel
+// coordinates.
+static void ssd1306_copy_clipped(ssd1306_surface_t *surface, uint8_t chXpos1,
+                                 uint8_t chYpos1, uint8_t chXpos2,
+                                 uint8_t chYpos2, int16_t chDstX,
+                                 int16_t chDstY) {
+  int16_t dx = chDstX - chXpos1;
+  int16_t dy = chDstY - chYpos1;
+  uint64_t src_mask = ssd1306_row_mask(chYpos1, chYpos2);
+  uint64_t dst_mask = ssd1306_column_shift(src_mask, dy) & surface->clip_rows;
+  int16_t width = chXpos2 - chXpos1 + 1;
+
+  for (int16_t i = 0; i < width; i++) {
+    int16_t src = dx > 0 ? chXpos2 - i : chXpos1 + i;
+    int16_t x = src + dx;
+    if (!ssd1306_clip_column(surface, x)) {
+      continue;
+    }
+    uint8_t *col = surface->fb[x];
+    uint64_t moved = ssd1306_column_shift(
+                         ssd1306_column_load(surface->fb[src]) & src_mask, dy) &
+                     dst_mask;
+    ssd1306_column_store(col, (ssd1306_column_load(col) & ~dst_mask) | moved);
+  }
+}
+
+void ssd1306_copy_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                         uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                         int16_t chDstX, int16_t chDstY) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  if (!ssd1306_bound_rect(surface, &chXpos1, &chYpos1, &chXpos2, &chYpos2)) {
+    return;
+  }
+  if (surface->transposed) {
+    SSD1306_SWAP(chDstX, chDstY);
+  }
+  ssd1306_copy_clipped(surface, chXpos1, chYpos1, chXpos2, chYpos2, chDstX,
+                       chDstY);
+}
+
+void ssd1306_move_region(ssd1306_handle_t dev, uint8_t chXpos1,
+                         uint8_t chYpos1, uint8_t chXpos2, uint8_t chYpos2,
+                         int16_t chDstX, int16_t chDstY, uint8_t chFill) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  if (!ssd1306_bound_rect(surface, &chXpos1, &chYpos1, &chXpos2, &chYpos2)) {
+    return;
+  }
+  if (surface->transposed) {
+    SSD1306_SWAP(chDstX, chDstY);
+  }
+  ssd1306_copy_clipped(surface, chXpos1, chYpos1, chXpos2, chYpos2, chDstX,
+                       chDstY);
+
+  // fill what the source leaves behind, sparing the destination
+  int16_t dst_x2 = chDstX + (chXpos2 - chXpos1);
+  uint64_t src_mask = ssd1306_row_mask(chYpos1, chYpos2);
+  uint64_t dst_mask = ssd1306_column_shift(src_mask, chDstY - chYpos1);
+  for (uint8_t x = chXpos1; x <= chXpos2; x++) {
+    uint64_t mask = src_mask & surface->clip_rows;
+    if (!ssd1306_clip_column(surface, x)) {
+      continue;
+    }
+    if (x >= chDstX && x <= dst_x2) {
+      mask &= ~dst_mask;
+    }
+    uint8_t *col = surface->fb[x];
+    uint64_t word = ssd1306_column_load(col) & ~mask;
+    ssd1306_column_store(col, chFill ? word | mask : word);
+  }
+}
+
+/*
+ * Batched primitives. Clipping and the rotation check are done once per
+ * batch, and each element then costs a couple of compares and one masked
+ * byte or column-word update.
+ */
+
+// Vertical run of len rows starting at (x, y) in panel coordinates.
+static inline void ssd1306_panel_vspan(ssd1306_surface_t *surface, uint8_t x,
+                                       uint8_t y, uint8_t len, bool on) {
+  if (!ssd1306_clip_column(surface, x) || y > surface->clip_y2 || !len) {
+    return;
+  }
+  uint64_t mask = ssd1306_row_mask(y, MIN(y + len - 1, surface->rows - 1)) &
+                  surface->clip_rows;
+  uint8_t *col = surface->fb[x];
+  uint64_t word = ssd1306_column_load(col);
+  ssd1306_column_store(col, on ? word | mask : word & ~mask);
+}
+
+// Horizontal run of len columns starting at (x, y) in panel coordinates.
+static inline void ssd1306_panel_hspan(ssd1306_surface_t *surface, uint8_t x,
+                                       uint8_t y, uint8_t len, bool on) {
+  if (x > surface->clip_x2 || y < surface->clip_y1 || y > surface->clip_y2) {
+    return;
+  }
+  uint8_t page = 7 - (y >> 3);
+  uint8_t bit = 0x80 >> (y & 7);
+  uint16_t end = MIN(x + len, surface->clip_x2 + 1);
+  x = MAX(x, surface->clip_x1);
+  for (; x < end; x++) {
+    if (on) {
+      surface->fb[x][page] |= bit;
+    } else {
+      surface->fb[x][page] &= ~bit;
+    }
+  }
+}
+
+void ssd1306_fill_points(ssd1306_handle_t dev, const ssd1306_point_t *points,
+                         size_t count, uint8_t chPoint) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+  size_t xoff = surface->transposed ? offsetof(ssd1306_point_t, y)
+                                   : offsetof(ssd1306_point_t, x);
+  size_t yoff = surface->transposed ? offsetof(ssd1306_point_t, x)
+                                   : offsetof(ssd1306_point_t, y);
+
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t *point = (const uint8_t *)&points[i];
+    uint8_t x = point[xoff], y = point[yoff];
+    if (!ssd1306_clip_column(surface, x) || y < surface->clip_y1 ||
+        y > surface->clip_y2) {
+      continue;
+    }
+    uint8_t *byte = &surface->fb[x][7 - (y >> 3)];
+    uint8_t bit = 0x80 >> (y & 7);
+    *byte = chPoint ? *byte | bit : *byte & ~bit;
+  }
+}
+
+void ssd1306_fill_hspans(ssd1306_handle_t dev, const ssd1306_span_t *spans,
+                         size_t count, uint8_t chPoint) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  if (surface->transposed) {
+    for (size_t i = 0; i < count; i++) {
+      ssd1306_panel_vspan(surface, spans[i].y, spans[i].x, spans[i].len,
+                          chPoint);
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      ssd1306_panel_hspan(surface, spans[i].x, spans[i].y, spans[i].len,
+                          chPoint);
+    }
+  }
+}
+
+void ssd1306_fill_vspans(ssd1306_handle_t dev, const ssd1306_span_t *spans,
+                         size_t count, uint8_t chPoint) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+
+  if (surface->transposed) {
+    for (size_t i = 0; i < count; i++) {
+      ssd1306_panel_hspan(surface, spans[i].y, spans[i].x, spans[i].len,
+                          chPoint);
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      ssd1306_panel_vspan(surface, spans[i].x, spans[i].y, spans[i].len,
+                          chPoint);
+    }
+  }
+}
+
+void ssd1306_draw_waveform(ssd1306_handle_t dev, uint8_t chXpos,
+                           const uint8_t *pchSamples, size_t count,
+                           bool connect) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+  uint8_t prev = count ? pchSamples[0] : 0;
+
+  count = MIN(count, (size_t)MAX(surface->width - chXpos, 0));
+  for (size_t i = 0; i < count; i++) {
+    uint8_t y = pchSamples[i];
+    uint8_t y0 = connect ? MIN(prev, y) : y;
+    uint8_t y1 = connect ? MAX(prev, y) : y;
+    prev = y;
+    if (y0 >= surface->height) {
+      continue;
+    }
+    // clamped first: 0..255 is 256 rows, which a uint8_t length wraps to 0
+    uint8_t len = MIN(y1, surface->height - 1) - y0 + 1;
+    if (surface->transposed) {
+      ssd1306_panel_hspan(surface, y0, chXpos + i, len, true);
+    } else {
+      ssd1306_panel_vspan(surface, chXpos + i, y0, len, true);
+    }
+  }
+}
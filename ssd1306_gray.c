@@ -0,0 +1,282 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_gray.h"
+#include "freertos/semphr.h"
+#include "nvbdflib.h"
+#include "ssd1306_concurrent.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+struct ssd1306_gray {
+  ssd1306_surface_t planes[SSD1306_GRAY_MAX_PLANES];
+  uint8_t (*pixels)[SSD1306_WIDTH][SSD1306_PAGES]; // one block for all planes
+  uint8_t plane_count;
+  TickType_t slot;
+  TaskHandle_t task;
+  TaskHandle_t waiter; // task blocked in ssd1306_gray_stop
+  atomic_bool run;     // cleared after waiter is set
+  ssd1306_refresh_mode_t saved_mode; // put back by ssd1306_gray_stop
+  ssd1306_gray_stats_t stats;
+};
+
+typedef struct {
+  ssd1306_gray_t *gray;
+  uint8_t level;
+} ssd1306_gray_pen_t;
+
+static void ssd1306_gray_task(void *arg) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)arg;
+  ssd1306_gray_t *gray = device->gray;
+  TickType_t wake = xTaskGetTickCount();
+
+  while (atomic_load(&gray->run)) {
+    for (uint8_t k = 0; k < gray->plane_count; k++) {
+      bool failed, missed;
+
+      ssd1306_lock(device);
+      memcpy(device->surface.fb, gray->pixels[k], SSD1306_FB_SIZE);
+      // the mirror gets the top plane, the image at half brightness and up,
+      // once per cycle
+      device->gray_subframe = k != gray->plane_count - 1;
+      // sent as copied: nothing drawn after the memcpy gets in
+      failed = ssd1306_refresh_and_unlock(device) != ESP_OK;
+
+      // binary weighted: plane k stays up for 2^k slots
+      if ((missed = xTaskDelayUntil(&wake, gray->slot << k) == pdFALSE)) {
+        wake = xTaskGetTickCount();
+      }
+
+      // counted under the lock, which ssd1306_gray_get_stats reads them under
+      ssd1306_lock(device);
+      gray->stats.transfers_failed += failed;
+      gray->stats.slots_missed += missed;
+      gray->stats.cycles += k == gray->plane_count - 1;
+      ssd1306_unlock(device);
+    }
+  }
+
+  xTaskNotifyGive(gray->waiter);
+  vTaskDelete(NULL);
+}
+
+esp_err_t ssd1306_gray_start(ssd1306_handle_t dev,
+                             const ssd1306_gray_config_t *config) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_gray_t *gray;
+  esp_err_t ret;
+
+  if (config->planes < 2 || config->planes > SSD1306_GRAY_MAX_PLANES ||
+      !config->slot_ms) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (device->gray) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  if (ssd1306_lock_create(device) != ESP_OK) {
+    return ESP_ERR_NO_MEM;
+  }
+  gray = calloc(1, sizeof(ssd1306_gray_t));
+  if (!gray ||
+      !(gray->pixels = calloc(config->planes, sizeof(*gray->pixels)))) {
+    free(gray);
+    return ESP_ERR_NO_MEM;
+  }
+  gray->plane_count = config->planes;
+  gray->slot = MAX(pdMS_TO_TICKS(config->slot_ms), 1);
+  for (uint8_t k = 0; k < gray->plane_count; k++) {
+    gray->planes[k] = device->surface;
+    gray->planes[k].fb = gray->pixels[k];
+  }
+
+  // everything allocated before the mode changes, so a failure leaves the
+  // display as it was
+  gray->saved_mode = device->refresh_mode;
+  if ((ret = ssd1306_set_refresh_mode(dev, SSD1306_REFRESH_DIFF)) != ESP_OK) {
+    free(gray->pixels);
+    free(gray);
+    return ret;
+  }
+  atomic_store(&gray->run, true);
+  ssd1306_lock(dev);
+  device->gray = gray;
+  ssd1306_unlock(dev);
+  if (xTaskCreatePinnedToCore(ssd1306_gray_task, "ssd1306_gray",
+                              config->task_stack, device,
+                              config->task_priority, &gray->task,
+                              config->task_core) != pdPASS) {
+    ssd1306_lock(dev);
+    device->gray = NULL;
+    ssd1306_unlock(dev);
+    ssd1306_set_refresh_mode(dev, gray->saved_mode);
+    free(gray->pixels);
+    free(gray);
+    return ESP_ERR_NO_MEM;
+  }
+
+  return ESP_OK;
+}
+
+void ssd1306_gray_stop(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_gray_t *gray;
+
+  ssd1306_lock(dev);
+  gray = device->gray;
+  ssd1306_unlock(dev);
+  if (!gray) {
+    return;
+  }
+  // the task reads waiter once it sees run cleared
+  gray->waiter = xTaskGetCurrentTaskHandle();
+  atomic_store(&gray->run, false);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  // detached under the lock, so gray drawing either sees it or sees NULL
+  ssd1306_lock(dev);
+  device->gray = NULL;
+  device->gray_subframe = false;
+  ssd1306_unlock(dev);
+  ssd1306_set_refresh_mode(dev, gray->saved_mode);
+  free(gray->pixels);
+  free(gray);
+}
+
+// Bring the planes' rotation and clip in line with the display's.
+static ssd1306_gray_t *ssd1306_gray_sync(ssd1306_dev_t *device) {
+  ssd1306_gray_t *gray = device->gray;
+
+  if (gray) {
+    for (uint8_t k = 0; k < gray->plane_count; k++) {
+      uint8_t(*fb)[SSD1306_PAGES] = gray->planes[k].fb;
+      gray->planes[k] = device->surface;
+      gray->planes[k].fb = fb;
+    }
+  }
+  return gray;
+}
+
+ssd1306_handle_t ssd1306_gray_plane(ssd1306_handle_t dev, uint8_t chPlane) {
+  ssd1306_gray_t *gray;
+
+  ssd1306_lock(dev);
+  gray = ssd1306_gray_sync((ssd1306_dev_t *)dev);
+  ssd1306_unlock(dev);
+  if (!gray || chPlane >= gray->plane_count) {
+    return NULL;
+  }
+  return (ssd1306_handle_t)&gray->planes[chPlane];
+}
+
+void ssd1306_gray_clear(ssd1306_handle_t dev, uint8_t chLevel) {
+  ssd1306_gray_t *gray;
+
+  ssd1306_lock(dev);
+  if ((gray = ssd1306_gray_sync((ssd1306_dev_t *)dev))) {
+    for (uint8_t k = 0; k < gray->plane_count; k++) {
+      ssd1306_clear_screen(&gray->planes[k], (chLevel >> k) & 1 ? 0xFF : 0x00);
+    }
+  }
+  ssd1306_unlock(dev);
+}
+
+void ssd1306_gray_fill_point(ssd1306_handle_t dev, uint8_t chXpos,
+                             uint8_t chYpos, uint8_t chLevel) {
+  ssd1306_gray_t *gray;
+
+  ssd1306_lock(dev);
+  if ((gray = ssd1306_gray_sync((ssd1306_dev_t *)dev))) {
+    for (uint8_t k = 0; k < gray->plane_count; k++) {
+      ssd1306_fill_point(&gray->planes[k], chXpos, chYpos, (chLevel >> k) & 1);
+    }
+  }
+  ssd1306_unlock(dev);
+}
+
+void ssd1306_gray_fill_rectangle(ssd1306_handle_t dev, uint8_t chXpos1,
+                                 uint8_t chYpos1, uint8_t chXpos2,
+                                 uint8_t chYpos2, uint8_t chLevel) {
+  ssd1306_gray_t *gray;
+
+  ssd1306_lock(dev);
+  if ((gray = ssd1306_gray_sync((ssd1306_dev_t *)dev))) {
+    for (uint8_t k = 0; k < gray->plane_count; k++) {
+      ssd1306_fill_rectangle(&gray->planes[k], chXpos1, chYpos1, chXpos2,
+                             chYpos2, (chLevel >> k) & 1);
+    }
+  }
+  ssd1306_unlock(dev);
+}
+
+static void ssd1306_gray_plot(ssd1306_gray_pen_t *pen, int x, int y,
+                              uint8_t level) {
+  for (uint8_t k = 0; k < pen->gray->plane_count; k++) {
+    ssd1306_fill_point(&pen->gray->planes[k], x, y, (level >> k) & 1);
+  }
+}
+
+static void ssd1306_gray_line_function(void *ctx, int16_t x, int16_t y) {
+  ssd1306_gray_pen_t *pen = (ssd1306_gray_pen_t *)ctx;
+
+  ssd1306_gray_plot(pen, x, y, pen->level);
+}
+
+void ssd1306_gray_draw_line(ssd1306_handle_t dev, int16_t chXpos1,
+                            int16_t chYpos1, int16_t chXpos2, int16_t chYpos2,
+                            uint8_t chLevel) {
+  ssd1306_gray_pen_t pen = {NULL, chLevel};
+
+  // every plane is written, clearing the points of planes whose bit of the
+  // level is 0
+  ssd1306_lock(dev);
+  if ((pen.gray = ssd1306_gray_sync((ssd1306_dev_t *)dev))) {
+    ssd1306_line_points(chXpos1, chYpos1, chXpos2, chYpos2,
+                        ssd1306_gray_line_function, &pen);
+  }
+  ssd1306_unlock(dev);
+}
+
+static void ssd1306_gray_text_function(int x, int y, int c, void *ctx) {
+  ssd1306_gray_pen_t *pen = (ssd1306_gray_pen_t *)ctx;
+
+  ssd1306_gray_plot(pen, x, y, c ? pen->level : 0);
+}
+
+void ssd1306_gray_draw_bdf_text(ssd1306_handle_t dev, uint8_t chXpos,
+                                uint8_t chYpos, const char *string,
+                                uint8_t chLevel) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_gray_pen_t pen = {NULL, chLevel};
+  void (*function)(int x, int y, int c, void *ctx);
+  void *ctx;
+  int width, height;
+
+  ssd1306_lock(dev);
+  if ((pen.gray = ssd1306_gray_sync(device)) && device->surface.bdf_font) {
+    // pen lives on this stack, so put back the drawing context found
+    bdfGetDrawingFunction(&function, &ctx);
+    bdfGetDrawingAreaSize(&width, &height);
+    bdfSetDrawingFunction(ssd1306_gray_text_function, &pen);
+    bdfSetDrawingAreaSize(device->surface.width, device->surface.height);
+    bdfPrintString(device->surface.bdf_font, chXpos, chYpos, (char *)string);
+    bdfSetDrawingFunction(function, ctx);
+    bdfSetDrawingAreaSize(width, height);
+  }
+  ssd1306_unlock(dev);
+}
+
+void ssd1306_gray_get_stats(ssd1306_handle_t dev, ssd1306_gray_stats_t *stats) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  ssd1306_lock(dev);
+  if (device->gray) {
+    *stats = device->gray->stats;
+  } else {
+    memset(stats, 0, sizeof(*stats));
+  }
+  ssd1306_unlock(dev);
+}
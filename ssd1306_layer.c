@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_layer.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+struct ssd1306_layer {
+  ssd1306_dev_t *device;
+  ssd1306_layer_t *next; // layer above this one
+  uint8_t (*pixels)[8];  // column words, same layout as the framebuffer
+  uint8_t (*mask)[8];    // NULL for unmasked layers
+  uint8_t width;
+  uint8_t height;
+  int16_t x;
+  int16_t y;
+  bool visible;
+  ssd1306_blend_t blend;
+};
+
+static void ssd1306_mark_columns(ssd1306_dev_t *device, int16_t x0,
+                                 int16_t x1) {
+  x0 = x0 < 0 ? 0 : x0;
+  x1 = x1 >= SSD1306_WIDTH ? SSD1306_WIDTH - 1 : x1;
+  for (int16_t x = x0; x <= x1; x++) {
+    device->compose_dirty[x / 32] |= 1u << (x % 32);
+  }
+}
+
+static void ssd1306_layer_mark(ssd1306_layer_t *layer, int16_t lx0,
+                               int16_t lx1) {
+  if (layer->visible) {
+    ssd1306_mark_columns(layer->device, layer->x + lx0, layer->x + lx1);
+  }
+}
+
+static void ssd1306_layer_blit(ssd1306_layer_t *layer, uint8_t (*dst)[8],
+                               uint8_t chXpos, uint8_t chYpos,
+                               const uint8_t *pchBmp, uint8_t chWidth,
+                               uint8_t chHeight) {
+  uint16_t byteWidth = (chWidth + 7) / 8;
+
+  if (chXpos >= layer->width || chYpos >= layer->height) {
+    return;
+  }
+  chWidth = MIN(chWidth, layer->width - chXpos);
+  chHeight = MIN(chHeight, layer->height - chYpos);
+  if (!chWidth || !chHeight) {
+    return;
+  }
+
+  uint64_t keep = ~ssd1306_row_mask(chYpos, chYpos + chHeight - 1);
+  uint64_t cols[8];
+  for (uint8_t i = 0; i < chWidth; i++) {
+    if (i % 8 == 0) {
+      ssd1306_bitmap_columns(pchBmp, byteWidth, i / 8, chHeight, cols);
+    }
+    uint8_t *col = dst[chXpos + i];
+    ssd1306_column_store(col, (ssd1306_column_load(col) & keep) |
+                                  (cols[i % 8] >> chYpos));
+  }
+  ssd1306_layer_mark(layer, chXpos, chXpos + chWidth - 1);
+}
+
+ssd1306_layer_handle_t ssd1306_layer_create(ssd1306_handle_t dev,
+                                            uint8_t chWidth, uint8_t chHeight,
+                                            bool masked) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_layer_t *layer, **tail;
+
+  if (!chWidth || !chHeight || chHeight > SSD1306_HEIGHT) {
+    return NULL;
+  }
+
+  layer = calloc(1, sizeof(ssd1306_layer_t));
+  if (!layer) {
+    return NULL;
+  }
+  layer->pixels = calloc(chWidth, sizeof(*layer->pixels));
+  layer->mask = masked ? calloc(chWidth, sizeof(*layer->mask)) : NULL;
+  if (!layer->pixels || (masked && !layer->mask)) {
+    free(layer->pixels);
+    free(layer->mask);
+    free(layer);
+    return NULL;
+  }
+  layer->device = device;
+  layer->width = chWidth;
+  layer->height = chHeight;
+  layer->blend = SSD1306_BLEND_REPLACE;
+  ssd1306_layer_clear(layer, 0);
+
+  for (tail = &device->layers; *tail; tail = &(*tail)->next)
+    ;
+  *tail = layer;
+
+  return (ssd1306_layer_handle_t)layer;
+}
+
+void ssd1306_layer_delete(ssd1306_layer_handle_t handle) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+  ssd1306_layer_t **link;
+
+  if (!layer) {
+    return;
+  }
+  for (link = &layer->device->layers; *link; link = &(*link)->next) {
+    if (*link == layer) {
+      *link = layer->next;
+      break;
+    }
+  }
+  ssd1306_layer_mark(layer, 0, layer->width - 1);
+  free(layer->pixels);
+  free(layer->mask);
+  free(layer);
+}
+
+void ssd1306_layer_set_position(ssd1306_layer_handle_t handle, int16_t x,
+                                int16_t y) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+
+  if (layer->x == x && layer->y == y) {
+    return;
+  }
+  ssd1306_layer_mark(layer, 0, layer->width - 1);
+  layer->x = x;
+  layer->y = y;
+  ssd1306_layer_mark(layer, 0, layer->width - 1);
+}
+
+void ssd1306_layer_set_visible(ssd1306_layer_handle_t handle, bool visible) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+
+  if (layer->visible == visible) {
+    return;
+  }
+  layer->visible = true;
+  ssd1306_layer_mark(layer, 0, layer->width - 1);
+  layer->visible = visible;
+}
+
+void ssd1306_layer_set_blend(ssd1306_layer_handle_t handle,
+                             ssd1306_blend_t blend) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+
+  layer->blend = blend;
+  ssd1306_layer_mark(layer, 0, layer->width - 1);
+}
+
+void ssd1306_layer_clear(ssd1306_layer_handle_t handle, uint8_t chFill) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+  uint64_t area = ssd1306_row_mask(0, layer->height - 1);
+
+  for (uint8_t x = 0; x < layer->width; x++) {
+    ssd1306_column_store(layer->pixels[x], chFill ? area : 0);
+    if (layer->mask) {
+      ssd1306_column_store(layer->mask[x], area);
+    }
+  }
+  ssd1306_layer_mark(layer, 0, layer->width - 1);
+}
+
+void ssd1306_layer_fill_point(ssd1306_layer_handle_t handle, uint8_t chXpos,
+                              uint8_t chYpos, uint8_t chPoint) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+  uint8_t chTemp;
+
+  if (chXpos >= layer->width || chYpos >= layer->height) {
+    return;
+  }
+  chTemp = 1 << (7 - chYpos % 8);
+  if (chPoint) {
+    layer->pixels[chXpos][7 - chYpos / 8] |= chTemp;
+  } else {
+    layer->pixels[chXpos][7 - chYpos / 8] &= ~chTemp;
+  }
+  ssd1306_layer_mark(layer, chXpos, chXpos);
+}
+
+void ssd1306_layer_draw_bitmap(ssd1306_layer_handle_t handle, uint8_t chXpos,
+                               uint8_t chYpos, const uint8_t *pchBmp,
+                               uint8_t chWidth, uint8_t chHeight) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+  ssd1306_layer_blit(layer, layer->pixels, chXpos, chYpos, pchBmp, chWidth,
+                     chHeight);
+}
+
+void ssd1306_layer_draw_mask(ssd1306_layer_handle_t handle, uint8_t chXpos,
+                             uint8_t chYpos, const uint8_t *pchMask,
+                             uint8_t chWidth, uint8_t chHeight) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+
+  if (layer->mask) {
+    ssd1306_layer_blit(layer, layer->mask, chXpos, chYpos, pchMask, chWidth,
+                       chHeight);
+  }
+}
+
+void ssd1306_layer_invalidate(ssd1306_layer_handle_t handle) {
+  ssd1306_layer_t *layer = (ssd1306_layer_t *)handle;
+  ssd1306_layer_mark(layer, 0, layer->width - 1);
+}
+
+// Blend every layer covering column x, bottom to top, as 64-bit column words.
+static uint64_t ssd1306_compose_column(const ssd1306_dev_t *device,
+                                       int16_t x) {
+  uint64_t acc = 0;
+
+  for (const ssd1306_layer_t *layer = device->layers; layer;
+       layer = layer->next) {
+    int16_t lx = x - layer->x;
+    if (!layer->visible || lx < 0 || lx >= layer->width) {
+      continue;
+    }
+
+    uint64_t pix = ssd1306_column_load(layer->pixels[lx]);
+    uint64_t mask = layer->mask ? ssd1306_column_load(layer->mask[lx])
+                                : ssd1306_row_mask(0, layer->height - 1);
+    pix = ssd1306_column_shift(pix & mask, layer->y);
+    mask = ssd1306_column_shift(mask, layer->y);
+
+    switch (layer->blend) {
+    case SSD1306_BLEND_REPLACE:
+      acc = (acc & ~mask) | pix;
+      break;
+    case SSD1306_BLEND_OR:
+      acc |= pix;
+      break;
+    case SSD1306_BLEND_AND:
+      acc &= pix | ~mask;
+      break;
+    case SSD1306_BLEND_XOR:
+      acc ^= pix;
+      break;
+    }
+  }
+  return acc;
+}
+
+void ssd1306_compose(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  ssd1306_lock(dev);
+  for (uint8_t w = 0; w < SSD1306_WIDTH / 32; w++) {
+    uint32_t dirty = device->compose_dirty[w];
+    device->compose_dirty[w] = 0;
+
+    while (dirty) {
+      int16_t x = w * 32 + __builtin_ctz(dirty);
+      uint8_t *col = device->surface.fb[x];
+      uint64_t word = ssd1306_compose_column(device, x);
+      uint64_t diff = ssd1306_column_load(col) ^ word;
+
+      dirty &= dirty - 1;
+      ssd1306_column_store(col, word);
+      // mark the pages that changed for ssd1306_refresh_dirty
+      for (uint8_t p = 0; p < SSD1306_PAGES; p++) {
+        if ((diff >> (8 * p)) & 0xFF) {
+          device->dirty[x] |= 1 << p;
+        }
+      }
+    }
+  }
+  ssd1306_unlock(dev);
+}
@@ -0,0 +1,245 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_mirror.h"
+#include "freertos/ringbuf.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+struct ssd1306_mirror {
+  uint8_t last[SSD1306_WIDTH][SSD1306_PAGES]; // last mirrored frame
+  uint8_t window[SSD1306_FB_SIZE];            // bytes of one window
+  uint8_t frame[SSD1306_MIRROR_FRAME_MAX];    // frame being encoded
+  size_t frame_len;
+  const uint8_t (*src)[SSD1306_PAGES]; // what frame is encoded from
+  bool primed;   // last holds a frame
+  bool keyframe; // next frame must cover the whole panel
+  RingbufHandle_t ring;
+  ssd1306_mirror_cb_t callback;
+  void *ctx;
+  TaskHandle_t task;
+  TaskHandle_t waiter; // task blocked in ssd1306_mirror_stop
+  atomic_bool run;     // cleared after waiter is set
+  ssd1306_mirror_stats_t stats;
+};
+
+// Encode n bytes as in ssd1306_rle.h, the way tools/ssd1306_rle.py does;
+// out needs room for n + n / 128 + 1 bytes.
+static size_t ssd1306_rle_compress(const uint8_t *src, size_t n,
+                                   uint8_t *out) {
+  size_t len = 0, literal = 0, i = 0;
+
+  while (i < n) {
+    size_t run = 1;
+    while (i + run < n && run < 129 && src[i + run] == src[i]) {
+      run++;
+    }
+    // a two-byte run only pays off if it doesn't split a literal
+    if (run >= 3 || (run == 2 && !literal)) {
+      if (literal) {
+        out[len++] = literal - 1;
+        memcpy(&out[len], &src[i - literal], literal);
+        len += literal;
+        literal = 0;
+      }
+      out[len++] = 0x80 | (run - 2);
+      out[len++] = src[i];
+      i += run;
+      continue;
+    }
+    literal++;
+    i++;
+    if (literal == 128 || i == n) {
+      out[len++] = literal - 1;
+      memcpy(&out[len], &src[i - literal], literal);
+      len += literal;
+      literal = 0;
+    }
+  }
+  return len;
+}
+
+static esp_err_t ssd1306_mirror_window(const ssd1306_window_t *win,
+                                       void *ctx) {
+  ssd1306_mirror_t *m = (ssd1306_mirror_t *)ctx;
+  uint8_t pages = win->p1 - win->p0 + 1;
+  size_t n = 0;
+
+  for (uint16_t x = win->c0; x <= win->c1; x++) {
+    memcpy(&m->window[n], &m->src[x][win->p0], pages);
+    n += pages;
+  }
+  m->frame[m->frame_len++] = win->c0;
+  m->frame[m->frame_len++] = win->c1;
+  m->frame[m->frame_len++] = win->p0;
+  m->frame[m->frame_len++] = win->p1;
+  m->frame_len += ssd1306_rle_compress(m->window, n, &m->frame[m->frame_len]);
+  m->frame[0]++;
+  return ESP_OK;
+}
+
+// Encode the pages flagged in masks, read from src, and queue the frame.
+static esp_err_t ssd1306_mirror_queue(ssd1306_mirror_t *m,
+                                      const uint8_t (*src)[SSD1306_PAGES],
+                                      const uint8_t *masks, bool keyframe) {
+  m->src = src;
+  m->frame[0] = 0; // window count
+  m->frame_len = 1;
+  ssd1306_merge_windows(masks, ssd1306_mirror_window, m);
+  if (!m->frame[0]) {
+    return ESP_OK; // nothing changed
+  }
+
+  if (xRingbufferSend(m->ring, m->frame, m->frame_len, 0) != pdTRUE) {
+    m->stats.dropped++;
+    m->keyframe = true; // the receiver lost track
+    return ESP_ERR_NO_MEM;
+  }
+  m->stats.frames++;
+  m->stats.keyframes += keyframe;
+  m->stats.bytes += m->frame_len;
+  m->keyframe = false;
+  return ESP_OK;
+}
+
+void ssd1306_mirror_capture(ssd1306_dev_t *device,
+                            const uint8_t (*frame)[SSD1306_PAGES]) {
+  ssd1306_mirror_t *m = device->mirror;
+  uint8_t masks[SSD1306_WIDTH];
+  bool keyframe;
+
+  if (!m) {
+    return;
+  }
+  keyframe = m->keyframe || !m->primed;
+  for (uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+    if (keyframe) {
+      masks[x] = 0xFF; // merges into one full window
+      continue;
+    }
+    masks[x] = 0;
+    for (uint8_t p = 0; p < SSD1306_PAGES; p++) {
+      if (frame[x][p] != m->last[x][p]) {
+        masks[x] |= 1 << p;
+      }
+    }
+  }
+  ssd1306_mirror_queue(m, frame, masks, keyframe);
+  memcpy(m->last, frame, SSD1306_FB_SIZE);
+  m->primed = true;
+}
+
+static void ssd1306_mirror_task(void *arg) {
+  ssd1306_mirror_t *m = (ssd1306_mirror_t *)arg;
+  size_t len;
+  void *frame;
+
+  while (atomic_load(&m->run)) {
+    // wake up now and then to notice ssd1306_mirror_stop
+    frame = xRingbufferReceive(m->ring, &len, pdMS_TO_TICKS(100));
+    if (frame) {
+      m->callback(frame, len, m->ctx);
+      vRingbufferReturnItem(m->ring, frame);
+    }
+  }
+
+  xTaskNotifyGive(m->waiter);
+  vTaskDelete(NULL);
+}
+
+esp_err_t ssd1306_mirror_start(ssd1306_handle_t dev,
+                               const ssd1306_mirror_config_t *config) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_mirror_t *m;
+
+  if (!config->callback || config->buffer_size < SSD1306_MIRROR_BUFFER_MIN) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (device->mirror) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  if (ssd1306_lock_create(device) != ESP_OK) {
+    return ESP_ERR_NO_MEM;
+  }
+  m = calloc(1, sizeof(ssd1306_mirror_t));
+  if (!m ||
+      !(m->ring = xRingbufferCreate(config->buffer_size, RINGBUF_TYPE_NOSPLIT))) {
+    free(m);
+    return ESP_ERR_NO_MEM;
+  }
+  m->callback = config->callback;
+  m->ctx = config->ctx;
+  atomic_store(&m->run, true);
+  if (xTaskCreatePinnedToCore(ssd1306_mirror_task, "ssd1306_mirror",
+                              config->task_stack, m, config->task_priority,
+                              &m->task, config->task_core) != pdPASS) {
+    vRingbufferDelete(m->ring);
+    free(m);
+    return ESP_ERR_NO_MEM;
+  }
+
+  ssd1306_lock_bus(device);
+  device->mirror = m;
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
+  return ESP_OK;
+}
+
+void ssd1306_mirror_stop(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_mirror_t *m;
+
+  // taken and cleared together, so only one caller stops the task
+  ssd1306_lock_bus(device);
+  m = device->mirror;
+  device->mirror = NULL; // no more captures
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
+  if (!m) {
+    return;
+  }
+
+  // the task reads waiter once it sees run cleared
+  m->waiter = xTaskGetCurrentTaskHandle();
+  atomic_store(&m->run, false);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  vRingbufferDelete(m->ring);
+  free(m);
+}
+
+esp_err_t ssd1306_mirror_send_keyframe(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  uint8_t masks[SSD1306_WIDTH];
+  esp_err_t ret = ESP_OK;
+
+  ssd1306_lock_bus(device);
+  if (!device->mirror) {
+    ret = ESP_ERR_INVALID_STATE;
+  } else if (device->mirror->primed) {
+    memset(masks, 0xFF, sizeof(masks));
+    ret = ssd1306_mirror_queue(device->mirror, device->mirror->last, masks,
+                               true);
+  }
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
+  return ret;
+}
+
+void ssd1306_mirror_get_stats(ssd1306_handle_t dev,
+                              ssd1306_mirror_stats_t *stats) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+
+  ssd1306_lock_bus(device);
+  if (device->mirror) {
+    *stats = device->mirror->stats;
+  } else {
+    memset(stats, 0, sizeof(*stats));
+  }
+  ssd1306_unlock_bus(device);
+  ssd1306_unlock(dev);
+}
@@ -0,0 +1,149 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_numeric.h"
+#include "ssd1306_canvas.h"
+#include "ssd1306_priv.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char s_chGlyphs[] = "0123456789+-.: ";
+#define SSD1306_NUMERIC_GLYPHS (sizeof(s_chGlyphs) - 1)
+
+typedef struct {
+  ssd1306_handle_t dev;
+  uint8_t x;
+  uint8_t y;
+  uint8_t cells;
+  uint8_t cell_width;
+  uint8_t cell_height;
+  bool drawn;
+  uint8_t shown[SSD1306_NUMERIC_MAX_CELLS]; // glyph index per cell
+  ssd1306_canvas_handle_t glyphs[SSD1306_NUMERIC_GLYPHS];
+} ssd1306_numeric_t;
+
+ssd1306_numeric_handle_t ssd1306_numeric_create(ssd1306_handle_t dev,
+                                                uint8_t chXpos, uint8_t chYpos,
+                                                uint8_t chCells) {
+  const ssd1306_surface_t *surface = (const ssd1306_surface_t *)dev;
+  const BDF_FONT *font = surface->bdf_font;
+  ssd1306_numeric_t *numeric;
+  int width = 1;
+
+  if (!font || !chCells || chCells > SSD1306_NUMERIC_MAX_CELLS ||
+      font->info.BBox.h <= 0 || font->info.BBox.h > SSD1306_HEIGHT) {
+    return NULL;
+  }
+  for (size_t i = 0; i < SSD1306_NUMERIC_GLYPHS; i++) {
+    const FontChar *ch = ssd1306_font_char(font, s_chGlyphs[i]);
+    if (ch) {
+      width = MAX(width, MAX(ch->Metrics.dwx0, ch->BBox.xOff + ch->BBox.w));
+    }
+  }
+  // the whole field must fit, or the cell positions wrap around
+  if (chXpos + width * chCells > surface->width ||
+      chYpos + font->info.BBox.h > surface->height) {
+    return NULL;
+  }
+
+  numeric = calloc(1, sizeof(ssd1306_numeric_t));
+  if (!numeric) {
+    return NULL;
+  }
+  numeric->dev = dev;
+  numeric->x = chXpos;
+  numeric->y = chYpos;
+  numeric->cells = chCells;
+  numeric->cell_width = width;
+  numeric->cell_height = font->info.BBox.h;
+
+  // one column past the cell keeps BDF word wrap from kicking in
+  for (size_t i = 0; i < SSD1306_NUMERIC_GLYPHS; i++) {
+    const char text[2] = {s_chGlyphs[i], 0};
+    numeric->glyphs[i] = ssd1306_canvas_create(width + 1, numeric->cell_height);
+    if (!numeric->glyphs[i]) {
+      ssd1306_numeric_delete(numeric);
+      return NULL;
+    }
+    ssd1306_canvas_set_font(numeric->glyphs[i], dev);
+    ssd1306_draw_bdf_text(numeric->glyphs[i], 0, 0, text);
+  }
+
+  return (ssd1306_numeric_handle_t)numeric;
+}
+
+void ssd1306_numeric_delete(ssd1306_numeric_handle_t numeric) {
+  ssd1306_numeric_t *n = (ssd1306_numeric_t *)numeric;
+
+  for (size_t i = 0; i < SSD1306_NUMERIC_GLYPHS; i++) {
+    if (n->glyphs[i]) {
+      ssd1306_canvas_delete(n->glyphs[i]);
+    }
+  }
+  free(n);
+}
+
+esp_err_t ssd1306_numeric_set_text(ssd1306_numeric_handle_t numeric,
+                                   const char *text) {
+  ssd1306_numeric_t *n = (ssd1306_numeric_t *)numeric;
+  size_t len = strlen(text);
+
+  if (len > n->cells) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  for (uint8_t cell = 0; cell < n->cells; cell++) {
+    // right-aligned: leading cells are blank
+    char chr = cell < n->cells - len ? ' ' : text[cell - (n->cells - len)];
+    const char *found = strchr(s_chGlyphs, chr);
+    uint8_t glyph = found && chr ? (uint8_t)(found - s_chGlyphs)
+                                 : SSD1306_NUMERIC_GLYPHS - 1;
+
+    if (n->drawn && n->shown[cell] == glyph) {
+      continue;
+    }
+    uint8_t x = n->x + cell * n->cell_width;
+    ssd1306_blit_region(n->dev, x, n->y, n->glyphs[glyph], 0, 0,
+                        n->cell_width, n->cell_height);
+    ssd1306_mark_dirty(n->dev, x, n->y, x + n->cell_width - 1,
+                       n->y + n->cell_height - 1);
+    n->shown[cell] = glyph;
+  }
+  n->drawn = true;
+
+  return ESP_OK;
+}
+
+esp_err_t ssd1306_numeric_set_fixed(ssd1306_numeric_handle_t numeric,
+                                    int32_t value, uint8_t decimals) {
+  char text[SSD1306_NUMERIC_MAX_CELLS + 2];
+  int64_t mag = value < 0 ? -(int64_t)value : value;
+  int64_t scale = 1;
+  int len;
+
+  if (decimals > SSD1306_NUMERIC_MAX_CELLS) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (!decimals) {
+    len = snprintf(text, sizeof(text), "%ld", (long)value);
+  } else {
+    for (uint8_t i = 0; i < decimals; i++) {
+      scale *= 10;
+    }
+    len = snprintf(text, sizeof(text), "%s%lld.%0*lld", value < 0 ? "-" : "",
+                   (long long)(mag / scale), decimals,
+                   (long long)(mag % scale));
+  }
+  if (len < 0 || len >= (int)sizeof(text)) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  return ssd1306_numeric_set_text(numeric, text);
+}
+
+esp_err_t ssd1306_numeric_set_int(ssd1306_numeric_handle_t numeric,
+                                  int32_t value) {
+  return ssd1306_numeric_set_fixed(numeric, value, 0);
+}
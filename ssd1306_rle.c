@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_rle.h"
+#include "ssd1306_priv.h"
+
+#define SSD1306_RLE_HEADER 2
+
+static inline bool ssd1306_rle_available(ssd1306_rle_reader_t *reader) {
+  return reader->len || (reader->refill && reader->refill(reader));
+}
+
+bool ssd1306_rle_read_raw(ssd1306_rle_reader_t *reader, uint8_t *out,
+                          size_t n) {
+  while (n) {
+    if (!ssd1306_rle_available(reader)) {
+      return false;
+    }
+    size_t chunk = MIN(n, reader->len);
+    memcpy(out, reader->src, chunk);
+    reader->src += chunk;
+    reader->len -= chunk;
+    out += chunk;
+    n -= chunk;
+  }
+  return true;
+}
+
+bool ssd1306_rle_read(ssd1306_rle_reader_t *reader, uint8_t *out, size_t n) {
+  while (n) {
+    if (!reader->op_left) {
+      uint8_t op;
+      if (!ssd1306_rle_read_raw(reader, &op, 1)) {
+        return false;
+      }
+      reader->op_run = op & 0x80;
+      reader->op_left = reader->op_run ? (op & 0x7F) + 2 : op + 1;
+      if (reader->op_run &&
+          !ssd1306_rle_read_raw(reader, &reader->op_byte, 1)) {
+        return false;
+      }
+    }
+
+    size_t chunk = MIN(n, reader->op_left);
+    if (reader->op_run) {
+      memset(out, reader->op_byte, chunk);
+    } else if (!ssd1306_rle_read_raw(reader, out, chunk)) {
+      return false;
+    }
+    out += chunk;
+    n -= chunk;
+    reader->op_left -= chunk;
+  }
+  return true;
+}
+
+esp_err_t ssd1306_draw_rle_bitmap(ssd1306_handle_t dev, uint8_t chXpos,
+                                  uint8_t chYpos, const uint8_t *pchRle,
+                                  size_t len) {
+  ssd1306_surface_t *surface = (ssd1306_surface_t *)dev;
+  ssd1306_rle_reader_t reader = {0};
+  uint8_t width, stripes, column[8] = {0};
+
+  if (len < SSD1306_RLE_HEADER || !pchRle[0] || pchRle[0] > SSD1306_WIDTH ||
+      !pchRle[1] || pchRle[1] > SSD1306_HEIGHT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  reader.src = pchRle + SSD1306_RLE_HEADER;
+  reader.len = len - SSD1306_RLE_HEADER;
+  width = pchRle[0];
+  stripes = (pchRle[1] + 7) / 8;
+
+  for (uint8_t i = 0; i < width; i++) {
+    if (!ssd1306_rle_read(&reader, column, stripes)) {
+      return ESP_ERR_INVALID_SIZE;
+    }
+    if (!ssd1306_clip_column(surface, chXpos + i) || chYpos >= surface->rows) {
+      continue; // keep decoding: later columns may still be on screen
+    }
+
+    // the stripes are top-down, the column word bottom-up
+    uint64_t word = __builtin_bswap64(ssd1306_column_load(column));
+    if (word) {
+      uint8_t *col = surface->fb[chXpos + i];
+      ssd1306_column_store(col, ssd1306_column_load(col) |
+                                    (word >> chYpos & surface->clip_rows));
+    }
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t ssd1306_refresh_rle_bitmap(ssd1306_handle_t dev,
+                                     const uint8_t *pchRle, size_t len) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_rle_reader_t reader = {0};
+  uint8_t column[SSD1306_PAGES];
+
+  if (len < SSD1306_RLE_HEADER || pchRle[0] != SSD1306_WIDTH ||
+      pchRle[1] != SSD1306_HEIGHT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  reader.src = pchRle + SSD1306_RLE_HEADER;
+  reader.len = len - SSD1306_RLE_HEADER;
+
+  // decode once, into the snapshot when there is one, so a truncated image
+  // leaves the framebuffer alone; the bus lock keeps refreshes off it
+  ssd1306_lock_bus(device);
+  uint8_t(*frame)[SSD1306_PAGES] =
+      device->snapshot ? device->snapshot : device->surface.fb;
+  for (uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+    if (!ssd1306_rle_read(&reader, column, sizeof(column))) {
+      ssd1306_unlock_bus(device);
+      ssd1306_unlock(device);
+      return ESP_ERR_INVALID_SIZE;
+    }
+    ssd1306_column_store(frame[x],
+                         __builtin_bswap64(ssd1306_column_load(column)));
+  }
+  return ssd1306_refresh_frame_and_unlock(device, frame);
+}
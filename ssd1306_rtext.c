@@ -0,0 +1,251 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_rtext.h"
+#include "ssd1306_canvas.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+typedef struct {
+  int16_t dx; // top-left corner of the cell, relative to the cursor
+  int16_t dy;
+  uint8_t width; // cell size, after rotation
+  uint8_t height;
+  int16_t advance;
+  uint16_t column; // first column of the cell in columns
+} ssd1306_rtext_glyph_t;
+
+typedef struct {
+  ssd1306_rotation_t angle;
+  int16_t line_height;
+  uint8_t index[256]; // glyph number + 1 per character, 0 if not cached
+  ssd1306_rtext_glyph_t *glyphs;
+  uint8_t (*columns)[SSD1306_PAGES]; // every cell, column layout
+} ssd1306_rtext_t;
+
+static const char s_chPrintable[] =
+    " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`"
+    "abcdefghijklmnopqrstuvwxyz{|}~";
+
+static uint64_t ssd1306_reverse64(uint64_t x) {
+  x = (x >> 1 & 0x5555555555555555ULL) | (x & 0x5555555555555555ULL) << 1;
+  x = (x >> 2 & 0x3333333333333333ULL) | (x & 0x3333333333333333ULL) << 2;
+  x = (x >> 4 & 0x0F0F0F0F0F0F0F0FULL) | (x & 0x0F0F0F0F0F0F0F0FULL) << 4;
+  return __builtin_bswap64(x);
+}
+
+// Glyph row y as a column word, glyph column 0 in bit 63.
+static uint64_t ssd1306_rtext_row(const FontChar *ch, uint8_t stride, int y) {
+  uint64_t word = 0;
+
+  for (uint8_t k = 0; k < stride; k++) {
+    word |= (uint64_t)ch->bitmap[y * stride + k] << (56 - 8 * k);
+  }
+  return word;
+}
+
+// Size of a glyph's cell after rotation; false if it does not fit a column.
+static bool ssd1306_rtext_cell(const FontChar *ch, ssd1306_rotation_t angle,
+                               uint8_t *width, uint8_t *height) {
+  int w = ch->BBox.w > 0 && ch->BBox.h > 0 ? (ch->BBox.w + 7) & ~7 : 0;
+  int h = w ? ch->BBox.h : 0;
+
+  if (angle == SSD1306_ROTATION_90 || angle == SSD1306_ROTATION_270) {
+    int t = w;
+    w = h;
+    h = t;
+  }
+  *width = w;
+  *height = h;
+  return w <= UINT8_MAX && h <= SSD1306_HEIGHT;
+}
+
+// Rotate one glyph into its cell. The horizontal glyph covers u in
+// xoff..xoff + pw - 1 and v in top..top + h - 1 relative to the cursor;
+// rotating (u, v) clockwise gives (-v, u), (-u, -v) and (v, -u).
+static void ssd1306_rtext_rotate(const ssd1306_rtext_t *rt, const BDF_FONT *font,
+                                 const FontChar *ch,
+                                 ssd1306_rtext_glyph_t *glyph) {
+  uint8_t stride = (ch->BBox.w + 7) / 8;
+  int16_t pw = stride * 8, h = ch->BBox.h, xoff = ch->BBox.xOff;
+  int16_t top = font->info.BBox.h - h + font->info.BBox.yOff - ch->BBox.yOff;
+  uint8_t(*cols)[SSD1306_PAGES] = rt->columns + glyph->column;
+  uint64_t words[8];
+
+  switch (rt->angle) {
+  case SSD1306_ROTATION_0:
+  case SSD1306_ROTATION_180:
+    if (rt->angle == SSD1306_ROTATION_0) {
+      glyph->dx = xoff;
+      glyph->dy = top;
+    } else {
+      glyph->dx = -xoff - pw + 1;
+      glyph->dy = -top - h + 1;
+    }
+    for (uint8_t k = 0; k < stride; k++) {
+      ssd1306_bitmap_columns(ch->bitmap, stride, k, h, words);
+      for (uint8_t c = 0; c < 8; c++) {
+        if (rt->angle == SSD1306_ROTATION_0) {
+          ssd1306_column_store(cols[8 * k + c], words[c]);
+        } else {
+          ssd1306_column_store(cols[pw - 1 - 8 * k - c],
+                               ssd1306_reverse64(words[c]) << (64 - h));
+        }
+      }
+    }
+    break;
+  case SSD1306_ROTATION_90:
+    glyph->dx = -top - h + 1;
+    glyph->dy = xoff;
+    for (int16_t i = 0; i < h; i++) {
+      ssd1306_column_store(cols[i], ssd1306_rtext_row(ch, stride, h - 1 - i));
+    }
+    break;
+  case SSD1306_ROTATION_270:
+    glyph->dx = top;
+    glyph->dy = -xoff - pw + 1;
+    for (int16_t i = 0; i < h; i++) {
+      ssd1306_column_store(
+          cols[i], ssd1306_reverse64(ssd1306_rtext_row(ch, stride, i))
+                       << (64 - pw));
+    }
+    break;
+  }
+}
+
+ssd1306_rtext_handle_t ssd1306_rtext_create(ssd1306_handle_t dev,
+                                            ssd1306_rotation_t angle,
+                                            const char *charset) {
+  const BDF_FONT *font = ((ssd1306_surface_t *)dev)->bdf_font;
+  const FontChar *chars[UINT8_MAX];
+  uint8_t index[256] = {0};
+  uint16_t count = 0;
+  uint32_t columns = 0;
+  ssd1306_rtext_t *rt;
+  uint8_t width, height;
+
+  if (!font || angle > SSD1306_ROTATION_270) {
+    return NULL;
+  }
+  // find the glyphs and size the cache
+  for (const char *c = charset ? charset : s_chPrintable; *c; c++) {
+    uint8_t chr = *c;
+    const FontChar *ch;
+
+    if (index[chr] || !(ch = ssd1306_font_char(font, chr))) {
+      continue;
+    }
+    if (!ssd1306_rtext_cell(ch, angle, &width, &height)) {
+      return NULL;
+    }
+    chars[count] = ch;
+    index[chr] = ++count;
+    columns += height ? width : 0;
+  }
+  if (columns > UINT16_MAX) {
+    return NULL;
+  }
+
+  // one block: header, glyphs, cells
+  rt = calloc(1, sizeof(ssd1306_rtext_t) +
+                     count * sizeof(ssd1306_rtext_glyph_t) +
+                     columns * SSD1306_PAGES);
+  if (!rt) {
+    return NULL;
+  }
+  rt->angle = angle;
+  rt->line_height = font->info.BBox.h;
+  memcpy(rt->index, index, sizeof(index));
+  rt->glyphs = (ssd1306_rtext_glyph_t *)(rt + 1);
+  rt->columns = (uint8_t(*)[SSD1306_PAGES])(rt->glyphs + count);
+
+  columns = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    ssd1306_rtext_glyph_t *glyph = &rt->glyphs[i];
+
+    ssd1306_rtext_cell(chars[i], angle, &width, &height);
+    glyph->advance = chars[i]->Metrics.dwx0;
+    if (!height || !chars[i]->bitmap) {
+      continue; // advances without drawing
+    }
+    glyph->width = width;
+    glyph->height = height;
+    glyph->column = columns;
+    ssd1306_rtext_rotate(rt, font, chars[i], glyph);
+    columns += width;
+  }
+
+  return (ssd1306_rtext_handle_t)rt;
+}
+
+void ssd1306_rtext_delete(ssd1306_rtext_handle_t rtext) { free(rtext); }
+
+void ssd1306_rtext_draw(ssd1306_handle_t dev, ssd1306_rtext_handle_t rtext,
+                        int16_t chXpos, int16_t chYpos, const char *string) {
+  const ssd1306_rtext_t *rt = (const ssd1306_rtext_t *)rtext;
+  ssd1306_surface_t cell = {0};
+  int16_t u = 0, v = 0, x, y;
+
+  for (; *string; string++) {
+    uint8_t chr = *string;
+
+    if (chr == '\n') {
+      u = 0;
+      v += rt->line_height;
+    }
+    if (!rt->index[chr]) {
+      continue;
+    }
+    const ssd1306_rtext_glyph_t *glyph = &rt->glyphs[rt->index[chr] - 1];
+
+    if (glyph->height) {
+      // the cursor, rotated about the origin
+      switch (rt->angle) {
+      case SSD1306_ROTATION_0:
+        x = chXpos + u;
+        y = chYpos + v;
+        break;
+      case SSD1306_ROTATION_90:
+        x = chXpos - v;
+        y = chYpos + u;
+        break;
+      case SSD1306_ROTATION_180:
+        x = chXpos - u;
+        y = chYpos - v;
+        break;
+      default:
+        x = chXpos + v;
+        y = chYpos - u;
+        break;
+      }
+      cell.fb = rt->columns + glyph->column;
+      cell.columns = cell.width = glyph->width;
+      cell.rows = cell.height = glyph->height;
+      ssd1306_blit_region(dev, x + glyph->dx, y + glyph->dy, &cell, 0, 0,
+                          glyph->width, glyph->height);
+    }
+    u += glyph->advance;
+  }
+}
+
+uint16_t ssd1306_rtext_measure(ssd1306_rtext_handle_t rtext,
+                               const char *string) {
+  const ssd1306_rtext_t *rt = (const ssd1306_rtext_t *)rtext;
+  int32_t u = 0, longest = 0;
+
+  for (; *string; string++) {
+    uint8_t chr = *string;
+
+    if (chr == '\n') {
+      u = 0;
+    }
+    if (rt->index[chr]) {
+      u += rt->glyphs[rt->index[chr] - 1].advance;
+    }
+    longest = MAX(longest, u);
+  }
+  return MIN(longest, UINT16_MAX);
+}
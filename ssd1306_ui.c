@@ -0,0 +1,444 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "ssd1306_ui.h"
+#include "ssd1306_priv.h"
+#include <stdlib.h>
+
+typedef enum {
+  SSD1306_WIDGET_BOX = 0,
+  SSD1306_WIDGET_LABEL,
+  SSD1306_WIDGET_ICON,
+  SSD1306_WIDGET_BAR,
+} ssd1306_widget_type_t;
+
+struct ssd1306_widget {
+  ssd1306_dev_t *device;
+  ssd1306_widget_t *parent;
+  ssd1306_widget_t *children; // bottom-most first
+  ssd1306_widget_t *next;     // sibling drawn above this one
+  ssd1306_widget_type_t type;
+  uint8_t x; // relative to the parent
+  uint8_t y;
+  uint8_t width;
+  uint8_t height;
+  bool visible;
+  union {
+    uint8_t style;       // box
+    char *text;          // label
+    const uint8_t *bmp;  // icon
+    uint8_t value;       // bar
+  };
+};
+
+static bool ssd1306_rect_intersect(ssd1306_rect_t *r, const ssd1306_rect_t *a) {
+  r->x1 = MAX(r->x1, a->x1);
+  r->y1 = MAX(r->y1, a->y1);
+  r->x2 = MIN(r->x2, a->x2);
+  r->y2 = MIN(r->y2, a->y2);
+  return r->x1 <= r->x2 && r->y1 <= r->y2;
+}
+
+static int32_t ssd1306_rect_area(const ssd1306_rect_t *r) {
+  return (int32_t)(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+static ssd1306_rect_t ssd1306_rect_union(const ssd1306_rect_t *a,
+                                         const ssd1306_rect_t *b) {
+  ssd1306_rect_t r = {MIN(a->x1, b->x1), MIN(a->y1, b->y1), MAX(a->x2, b->x2),
+                      MAX(a->y2, b->y2)};
+  return r;
+}
+
+// Screen area a widget covers: its bounds clipped by every ancestor and the
+// screen. False if it or an ancestor is hidden, or nothing is on screen.
+static bool ssd1306_widget_area(const ssd1306_widget_t *widget,
+                                ssd1306_rect_t *area) {
+  const ssd1306_surface_t *surface = &widget->device->surface;
+  ssd1306_rect_t screen = {0, 0, surface->width - 1, surface->height - 1};
+  const ssd1306_widget_t *w;
+  int16_t x = 0, y = 0;
+
+  for (w = widget; w; w = w->parent) {
+    if (!w->visible) {
+      return false;
+    }
+    x += w->x;
+    y += w->y;
+  }
+  *area = (ssd1306_rect_t){x, y, x + widget->width - 1, y + widget->height - 1};
+
+  // walk back up, (x, y) becoming each ancestor's absolute position
+  for (w = widget; w->parent; w = w->parent) {
+    const ssd1306_widget_t *parent = w->parent;
+    x -= w->x;
+    y -= w->y;
+    ssd1306_rect_t bounds = {x, y, x + parent->width - 1,
+                             y + parent->height - 1};
+    if (!ssd1306_rect_intersect(area, &bounds)) {
+      return false;
+    }
+  }
+  return ssd1306_rect_intersect(area, &screen);
+}
+
+// Record a damaged rectangle. Overlapping damage is folded together, and
+// when the list is full the new rectangle goes to whichever existing one
+// grows least.
+static void ssd1306_damage(ssd1306_dev_t *device, const ssd1306_rect_t *rect) {
+  ssd1306_rect_t r = *rect;
+  uint8_t best = 0;
+  int32_t growth = INT32_MAX;
+
+  for (uint8_t i = 0; i < device->damage_count; i++) {
+    ssd1306_rect_t overlap = device->damage[i];
+    ssd1306_rect_t merged = ssd1306_rect_union(&device->damage[i], &r);
+    if (ssd1306_rect_intersect(&overlap, &r)) {
+      device->damage[i] = merged;
+      return;
+    }
+    int32_t g = ssd1306_rect_area(&merged) - ssd1306_rect_area(&device->damage[i]);
+    if (g < growth) {
+      growth = g;
+      best = i;
+    }
+  }
+  if (device->damage_count < SSD1306_DAMAGE_RECTS) {
+    device->damage[device->damage_count++] = r;
+  } else {
+    device->damage[best] = ssd1306_rect_union(&device->damage[best], &r);
+  }
+}
+
+static void ssd1306_widget_damage(const ssd1306_widget_t *widget) {
+  ssd1306_rect_t area;
+
+  if (ssd1306_widget_area(widget, &area)) {
+    ssd1306_damage(widget->device, &area);
+  }
+}
+
+static ssd1306_widget_t *ssd1306_widget_create(ssd1306_handle_t dev,
+                                               ssd1306_widget_handle_t parent,
+                                               ssd1306_widget_type_t type,
+                                               uint8_t chXpos, uint8_t chYpos,
+                                               uint8_t chWidth,
+                                               uint8_t chHeight) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_widget_t *widget, **tail;
+
+  if (!chWidth || !chHeight) {
+    return NULL;
+  }
+  widget = calloc(1, sizeof(ssd1306_widget_t));
+  if (!widget) {
+    return NULL;
+  }
+  widget->device = device;
+  widget->parent = (ssd1306_widget_t *)parent;
+  widget->type = type;
+  widget->x = chXpos;
+  widget->y = chYpos;
+  widget->width = chWidth;
+  widget->height = chHeight;
+  widget->visible = true;
+
+  tail = widget->parent ? &widget->parent->children : &device->widgets;
+  while (*tail) {
+    tail = &(*tail)->next;
+  }
+  *tail = widget;
+
+  return widget;
+}
+
+ssd1306_widget_handle_t ssd1306_box_create(ssd1306_handle_t dev,
+                                           ssd1306_widget_handle_t parent,
+                                           uint8_t chXpos, uint8_t chYpos,
+                                           uint8_t chWidth, uint8_t chHeight,
+                                           uint8_t chStyle) {
+  ssd1306_widget_t *widget =
+      ssd1306_widget_create(dev, parent, SSD1306_WIDGET_BOX, chXpos, chYpos,
+                            chWidth, chHeight);
+
+  if (widget) {
+    widget->style = chStyle;
+    ssd1306_widget_damage(widget);
+  }
+  return (ssd1306_widget_handle_t)widget;
+}
+
+ssd1306_widget_handle_t ssd1306_label_create(ssd1306_handle_t dev,
+                                             ssd1306_widget_handle_t parent,
+                                             uint8_t chXpos, uint8_t chYpos,
+                                             uint8_t chWidth, uint8_t chHeight,
+                                             const char *text) {
+  ssd1306_widget_t *widget =
+      ssd1306_widget_create(dev, parent, SSD1306_WIDGET_LABEL, chXpos, chYpos,
+                            chWidth, chHeight);
+
+  if (widget && ssd1306_label_set_text(widget, text) != ESP_OK) {
+    ssd1306_widget_delete(widget);
+    return NULL;
+  }
+  return (ssd1306_widget_handle_t)widget;
+}
+
+ssd1306_widget_handle_t ssd1306_icon_create(ssd1306_handle_t dev,
+                                            ssd1306_widget_handle_t parent,
+                                            uint8_t chXpos, uint8_t chYpos,
+                                            const uint8_t *pchBmp,
+                                            uint8_t chWidth, uint8_t chHeight) {
+  ssd1306_widget_t *widget =
+      ssd1306_widget_create(dev, parent, SSD1306_WIDGET_ICON, chXpos, chYpos,
+                            chWidth, chHeight);
+
+  if (widget) {
+    widget->bmp = pchBmp;
+    ssd1306_widget_damage(widget);
+  }
+  return (ssd1306_widget_handle_t)widget;
+}
+
+ssd1306_widget_handle_t ssd1306_bar_create(ssd1306_handle_t dev,
+                                           ssd1306_widget_handle_t parent,
+                                           uint8_t chXpos, uint8_t chYpos,
+                                           uint8_t chWidth, uint8_t chHeight,
+                                           uint8_t chValue) {
+  ssd1306_widget_t *widget =
+      ssd1306_widget_create(dev, parent, SSD1306_WIDGET_BAR, chXpos, chYpos,
+                            chWidth, chHeight);
+
+  if (widget) {
+    widget->value = MIN(chValue, 100);
+    ssd1306_widget_damage(widget);
+  }
+  return (ssd1306_widget_handle_t)widget;
+}
+
+static void ssd1306_widget_free(ssd1306_widget_t *widget) {
+  while (widget->children) {
+    ssd1306_widget_t *child = widget->children;
+    widget->children = child->next;
+    ssd1306_widget_free(child);
+  }
+  if (widget->type == SSD1306_WIDGET_LABEL) {
+    free(widget->text);
+  }
+  free(widget);
+}
+
+void ssd1306_widget_delete(ssd1306_widget_handle_t widget) {
+  ssd1306_widget_t *w = (ssd1306_widget_t *)widget;
+  ssd1306_widget_t **link = w->parent ? &w->parent->children
+                                      : &w->device->widgets;
+
+  ssd1306_widget_damage(w);
+  while (*link != w) {
+    link = &(*link)->next;
+  }
+  *link = w->next;
+  ssd1306_widget_free(w);
+}
+
+void ssd1306_widget_set_position(ssd1306_widget_handle_t widget,
+                                 uint8_t chXpos, uint8_t chYpos) {
+  ssd1306_widget_t *w = (ssd1306_widget_t *)widget;
+
+  if (w->x == chXpos && w->y == chYpos) {
+    return;
+  }
+  ssd1306_widget_damage(w);
+  w->x = chXpos;
+  w->y = chYpos;
+  ssd1306_widget_damage(w);
+}
+
+void ssd1306_widget_set_visible(ssd1306_widget_handle_t widget, bool visible) {
+  ssd1306_widget_t *w = (ssd1306_widget_t *)widget;
+
+  if (w->visible == visible) {
+    return;
+  }
+  w->visible = true; // damage the area in either direction
+  ssd1306_widget_damage(w);
+  w->visible = visible;
+}
+
+esp_err_t ssd1306_box_set_style(ssd1306_widget_handle_t widget,
+                                uint8_t chStyle) {
+  ssd1306_widget_t *w = (ssd1306_widget_t *)widget;
+
+  if (w->type != SSD1306_WIDGET_BOX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (w->style != chStyle) {
+    w->style = chStyle;
+    ssd1306_widget_damage(w);
+  }
+  return ESP_OK;
+}
+
+esp_err_t ssd1306_label_set_text(ssd1306_widget_handle_t widget,
+                                 const char *text) {
+  ssd1306_widget_t *w = (ssd1306_widget_t *)widget;
+  char *copy;
+
+  // the widget's data is a union: text is only a string in a label
+  if (w->type != SSD1306_WIDGET_LABEL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (w->text && !strcmp(w->text, text)) {
+    return ESP_OK;
+  }
+  copy = malloc(strlen(text) + 1);
+  if (!copy) {
+    return ESP_ERR_NO_MEM;
+  }
+  strcpy(copy, text);
+  free(w->text);
+  w->text = copy;
+  ssd1306_widget_damage(w);
+
+  return ESP_OK;
+}
+
+esp_err_t ssd1306_icon_set_bitmap(ssd1306_widget_handle_t widget,
+                                  const uint8_t *pchBmp) {
+  ssd1306_widget_t *w = (ssd1306_widget_t *)widget;
+
+  if (w->type != SSD1306_WIDGET_ICON) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  w->bmp = pchBmp;
+  ssd1306_widget_damage(w);
+  return ESP_OK;
+}
+
+esp_err_t ssd1306_bar_set_value(ssd1306_widget_handle_t widget,
+                                uint8_t chValue) {
+  ssd1306_widget_t *w = (ssd1306_widget_t *)widget;
+
+  if (w->type != SSD1306_WIDGET_BAR) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  chValue = MIN(chValue, 100);
+  if (w->value != chValue) {
+    w->value = chValue;
+    ssd1306_widget_damage(w);
+  }
+  return ESP_OK;
+}
+
+static void ssd1306_draw_outline(ssd1306_dev_t *device, int16_t x1, int16_t y1,
+                                 int16_t x2, int16_t y2) {
+  ssd1306_fill_rectangle(device, x1, y1, x2, y1, 1);
+  ssd1306_fill_rectangle(device, x1, y2, x2, y2, 1);
+  ssd1306_fill_rectangle(device, x1, y1, x1, y2, 1);
+  ssd1306_fill_rectangle(device, x2, y1, x2, y2, 1);
+}
+
+// Draw one widget with its top-left corner at (x, y); the clip is already
+// set to the part that may change.
+static void ssd1306_widget_draw(const ssd1306_widget_t *widget, int16_t x,
+                                int16_t y) {
+  ssd1306_dev_t *device = widget->device;
+  // drawing coordinates are 8-bit; anything beyond is off screen anyway
+  int16_t x2 = MIN(x + widget->width - 1, UINT8_MAX);
+  int16_t y2 = MIN(y + widget->height - 1, UINT8_MAX);
+
+  switch (widget->type) {
+  case SSD1306_WIDGET_BOX:
+    if (widget->style & SSD1306_BOX_FILL) {
+      ssd1306_fill_rectangle(device, x, y, x2, y2, 1);
+    } else if (widget->style & SSD1306_BOX_BORDER) {
+      ssd1306_draw_outline(device, x, y, x2, y2);
+    }
+    break;
+  case SSD1306_WIDGET_LABEL:
+    if (device->surface.bdf_font) {
+      // x and y fit: ssd1306_widget_draw_list skips widgets past 255
+      ssd1306_draw_bdf_text(device, x, y, widget->text);
+    }
+    break;
+  case SSD1306_WIDGET_ICON:
+    if (widget->bmp) {
+      ssd1306_draw_bitmap(device, x, y, widget->bmp, widget->width,
+                          widget->height);
+    }
+    break;
+  case SSD1306_WIDGET_BAR:
+    if (widget->width < 5 || widget->height < 5) {
+      // too small for a frame: just the fill
+      int16_t fill = (widget->width * widget->value + 99) / 100;
+      if (fill) {
+        ssd1306_fill_rectangle(device, x, y, MIN(x + fill - 1, x2), y2, 1);
+      }
+      break;
+    }
+    ssd1306_draw_outline(device, x, y, x2, y2);
+    if (widget->value) {
+      int16_t inner = (widget->width - 4) * widget->value / 100;
+      if (inner) {
+        ssd1306_fill_rectangle(device, x + 2, y + 2, MIN(x + 1 + inner, x2),
+                               y2 - 2, 1);
+      }
+    }
+    break;
+  }
+}
+
+// Draw a list of siblings and their children inside area, with (x, y) the
+// absolute position of their parent.
+static void ssd1306_widget_draw_list(const ssd1306_widget_t *widget, int16_t x,
+                                     int16_t y, const ssd1306_rect_t *area) {
+  for (; widget; widget = widget->next) {
+    if (!widget->visible) {
+      continue;
+    }
+    int16_t wx = x + widget->x, wy = y + widget->y;
+    ssd1306_rect_t clip = {wx, wy, wx + widget->width - 1,
+                           wy + widget->height - 1};
+    if (!ssd1306_rect_intersect(&clip, area) || wx > UINT8_MAX ||
+        wy > UINT8_MAX) {
+      continue;
+    }
+    ssd1306_set_clip(widget->device, clip.x1, clip.y1, clip.x2, clip.y2);
+    ssd1306_widget_draw(widget, wx, wy);
+    ssd1306_widget_draw_list(widget->children, wx, wy, &clip);
+  }
+}
+
+void ssd1306_ui_render(ssd1306_handle_t dev) {
+  ssd1306_dev_t *device = (ssd1306_dev_t *)dev;
+  ssd1306_surface_t *surface = &device->surface;
+  uint8_t clip_x1, clip_y1, clip_x2, clip_y2;
+  uint64_t clip_rows;
+
+  ssd1306_lock(dev);
+  // the caller's clip, put back once the damage is redrawn
+  clip_x1 = surface->clip_x1;
+  clip_y1 = surface->clip_y1;
+  clip_x2 = surface->clip_x2;
+  clip_y2 = surface->clip_y2;
+  clip_rows = surface->clip_rows;
+
+  for (uint8_t i = 0; i < device->damage_count; i++) {
+    const ssd1306_rect_t *r = &device->damage[i];
+
+    ssd1306_set_clip(dev, r->x1, r->y1, r->x2, r->y2);
+    ssd1306_fill_rectangle(dev, r->x1, r->y1, r->x2, r->y2, 0);
+    ssd1306_widget_draw_list(device->widgets, 0, 0, r);
+    ssd1306_mark_dirty(dev, r->x1, r->y1, r->x2, r->y2);
+  }
+  surface->clip_x1 = clip_x1;
+  surface->clip_y1 = clip_y1;
+  surface->clip_x2 = clip_x2;
+  surface->clip_y2 = clip_y2;
+  surface->clip_rows = clip_rows;
+  device->damage_count = 0;
+  ssd1306_unlock(dev);
+}
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2025 Subalpine Circuits
+#
+# SPDX-License-Identifier: Apache-2.0
+"""Convert a BDF font to constexpr tables for include/ssd1306.hpp.
+
+    bdf2cpp.py unifont.bdf unifont > unifont.hpp
+    bdf2cpp.py --first 48 --last 57 digits.bdf digits > digits.hpp
+
+The output declares `inline constexpr ssd1306::Font <name>` covering the
+character codes --first..--last. Codes the font has no glyph for get an
+empty entry and are skipped when printing, as with ssd1306_draw_bdf_text.
+"""
+
+import argparse
+import sys
+
+
+def read_bdf(lines):
+    """Parse a BDF font.
+
+    Returns (bbox, glyphs) where bbox is the FONTBOUNDINGBOX (w, h, xoff,
+    yoff) and glyphs maps an encoding to (bbox, advance, rows), rows being
+    one bytes object per BBX row, padded to whole bytes.
+    """
+    font_bbox = (0, 0, 0, 0)
+    font_advance = 0
+    glyphs = {}
+    glyph = None
+    rows = None
+
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        keyword = words[0]
+        if rows is not None and keyword != "ENDCHAR":
+            stride = (glyph["bbox"][0] + 7) // 8
+            row = bytes.fromhex(words[0][:stride * 2].ljust(stride * 2, "0"))
+            rows.append(row)
+        elif keyword == "FONTBOUNDINGBOX":
+            font_bbox = tuple(int(v) for v in words[1:5])
+        elif keyword == "DWIDTH" and glyph is None:
+            font_advance = int(words[1])
+        elif keyword == "STARTCHAR":
+            glyph = {"encoding": -1, "bbox": font_bbox,
+                     "advance": font_advance}
+        elif glyph is None:
+            continue
+        elif keyword == "ENCODING":
+            glyph["encoding"] = int(words[1])
+        elif keyword == "DWIDTH":
+            glyph["advance"] = int(words[1])
+        elif keyword == "BBX":
+            glyph["bbox"] = tuple(int(v) for v in words[1:5])
+        elif keyword == "BITMAP":
+            rows = []
+        elif keyword == "ENDCHAR":
+            height = max(glyph["bbox"][1], 0)
+            stride = (max(glyph["bbox"][0], 0) + 7) // 8
+            rows = (rows or [])[:height]
+            rows += [bytes(stride)] * (height - len(rows))
+            # the first glyph of an encoding wins, as in nvbdflib
+            glyphs.setdefault(glyph["encoding"],
+                              (glyph["bbox"], glyph["advance"], rows))
+            glyph = rows = None
+
+    return font_bbox, glyphs
+
+
+def check_range(name, value, low, high):
+    if not low <= value <= high:
+        sys.exit(f"{name} {value} does not fit in {low}..{high}")
+
+
+def emit(out, name, font_bbox, glyphs, first, last):
+    check_range("font height", font_bbox[1], 0, 255)
+    check_range("font y offset", font_bbox[3], -128, 127)
+
+    entries = []
+    bitmap = bytearray()
+    for code in range(first, last + 1):
+        if code not in glyphs:
+            entries.append(((0, 0, 0, 0), 0, 0, f"{code}: none"))
+            continue
+        bbox, advance, rows = glyphs[code]
+        check_range(f"glyph {code} size", bbox[0], 0, 255)
+        check_range(f"glyph {code} size", bbox[1], 0, 255)
+        check_range(f"glyph {code} offset", bbox[2], -128, 127)
+        check_range(f"glyph {code} offset", bbox[3], -128, 127)
+        check_range(f"glyph {code} advance", advance, 0, 255)
+        label = repr(chr(code)) if 32 <= code < 127 else str(code)
+        entries.append((bbox, advance, len(bitmap), label))
+        for row in rows:
+            bitmap += row
+
+    out.write("// Generated by tools/bdf2cpp.py, do not edit.\n\n")
+    out.write("#pragma once\n\n#include \"ssd1306.hpp\"\n\n")
+
+    out.write(f"inline constexpr uint8_t {name}_bitmaps[] = {{\n")
+    for i in range(0, max(len(bitmap), 1), 12):
+        chunk = bitmap[i:i + 12] or b"\0"
+        out.write("    " + ", ".join(f"0x{b:02x}" for b in chunk) + ",\n")
+    out.write("};\n\n")
+
+    out.write(f"inline constexpr ssd1306::Glyph {name}_glyphs[] = {{\n")
+    for (w, h, xoff, yoff), advance, offset, label in entries:
+        out.write(f"    {{{w}, {h}, {xoff}, {yoff}, {advance}, {offset}}}, "
+                  f"// {label}\n")
+    out.write("};\n\n")
+
+    out.write(f"inline constexpr ssd1306::Font {name} = {{\n"
+              f"    {name}_glyphs, {name}_bitmaps, {first}, "
+              f"{last - first + 1}, {font_bbox[1]}, {font_bbox[3]}}};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("bdf", help="BDF font file")
+    parser.add_argument("name", help="C++ identifier of the font")
+    parser.add_argument("--first", type=int, default=32,
+                        help="first character code (default 32)")
+    parser.add_argument("--last", type=int, default=126,
+                        help="last character code (default 126)")
+    args = parser.parse_args()
+
+    if not 0 <= args.first <= args.last <= 0xFFFF:
+        parser.error("need 0 <= --first <= --last <= 65535")
+    with open(args.bdf, encoding="latin-1") as f:
+        font_bbox, glyphs = read_bdf(f)
+    emit(sys.stdout, args.name, font_bbox, glyphs, args.first, args.last)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Subalpine Circuits
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host benchmark for the BDF parser.
+ *
+ *   cc -O2 -I include tools/bdf_bench.c nvbdflib.c -o bdf_bench
+ *   ./bdf_bench unifont.bdf [iterations]
+ *
+ * Parses the whole file from memory, as ssd1306_load_bdf_buffer does, and
+ * prints the mean time per parse.
+ */
+
+#include "nvbdflib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_ms(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+int main(int argc, char **argv) {
+  FILE *file;
+  char *buffer;
+  long length;
+  int iterations = argc > 2 ? atoi(argv[2]) : 10;
+  double start, elapsed;
+  BDF_FONT *font;
+
+  if (argc < 2 || iterations < 1) {
+    fprintf(stderr, "usage: %s font.bdf [iterations]\n", argv[0]);
+    return 2;
+  }
+  if (!(file = fopen(argv[1], "rb"))) {
+    perror(argv[1]);
+    return 1;
+  }
+  fseek(file, 0, SEEK_END);
+  length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  buffer = malloc(length);
+  if (!buffer || fread(buffer, 1, length, file) != (size_t)length) {
+    fprintf(stderr, "%s: read failed\n", argv[1]);
+    return 1;
+  }
+  fclose(file);
+
+  start = now_ms();
+  for (int i = 0; i < iterations; i++) {
+    if (!(font = bdfReadBuffer(buffer, length))) {
+      fprintf(stderr, "%s: parse failed\n", argv[1]);
+      return 1;
+    }
+    if (i + 1 < iterations) {
+      bdfFree(font);
+    }
+  }
+  elapsed = (now_ms() - start) / iterations;
+
+  printf("%s: %ld bytes, %d glyphs, %.2f ms per parse, %.1f MB/s\n", argv[1],
+         length, font->info.chars, elapsed, length / elapsed / 1e3);
+  bdfFree(font);
+  free(buffer);
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2025 Subalpine Circuits
+#
+# SPDX-License-Identifier: Apache-2.0
+"""Encode a sequence of 128x64 PBM frames for the ssd1306_anim player.
+
+    ssd1306_anim.py --fps 20 -o boot.anim frame*.pbm
+    ssd1306_anim.py --fps 20 --name boot_anim frame*.pbm > boot_anim.h
+
+A file holding several concatenated PBM images is read as several frames.
+The stream format is described in include/ssd1306_anim.h.
+"""
+
+import argparse
+import struct
+import sys
+
+import ssd1306_rle
+
+WIDTH = 128
+PAGES = 8
+VERSION = 1
+
+# Bus cost of opening a GRAM window, as SSD1306_WINDOW_COST in the driver
+WINDOW_COST = 10
+
+
+def gram_bytes(rows):
+    """Frame as the panel's GRAM: gram[x][page], pixel row y in hardware
+    page 7 - y // 8, bit 7 - y % 8."""
+    gram = [[0] * PAGES for _ in range(WIDTH)]
+    for y, row in enumerate(rows):
+        for x, pixel in enumerate(row):
+            if pixel:
+                gram[x][PAGES - 1 - y // 8] |= 0x80 >> (y % 8)
+    return gram
+
+
+def _area(win):
+    c0, c1, p0, p1 = win
+    return (c1 - c0 + 1) * (p1 - p0 + 1)
+
+
+def changed_windows(prev, cur):
+    """Windows covering every changed byte, merged with the driver's cost
+    model: a changed column joins the open window when the unchanged bytes
+    this drags in cost less than setting up another window."""
+    windows = []
+    win = None
+    for x in range(WIDTH):
+        pages = [p for p in range(PAGES) if prev[x][p] != cur[x][p]]
+        if not pages:
+            continue
+        col = (x, x, pages[0], pages[-1])
+        if win:
+            merged = (win[0], x, min(win[2], col[2]), max(win[3], col[3]))
+            if _area(merged) <= _area(win) + _area(col) + WINDOW_COST:
+                win = merged
+                continue
+            windows.append(win)
+        win = col
+    if win:
+        windows.append(win)
+    return windows
+
+
+def encode_frame(prev, cur):
+    windows = ([(0, WIDTH - 1, 0, PAGES - 1)] if prev is None
+               else changed_windows(prev, cur))
+    out = bytearray([len(windows)])
+    for c0, c1, p0, p1 in windows:
+        data = bytes(cur[x][p] for x in range(c0, c1 + 1)
+                     for p in range(p0, p1 + 1))
+        out.extend((c0, c1, p0, p1))
+        out.extend(ssd1306_rle.compress(data))
+    return bytes(out)
+
+
+def read_frames(paths):
+    frames = []
+    for path in paths:
+        with open(path, "rb") as f:
+            data = f.read()
+        pos = 0
+        while data[pos:].strip():
+            width, height, rows, pos = ssd1306_rle.read_pbm(data, pos)
+            if (width, height) != (WIDTH, 64):
+                raise ValueError("%s: frames must be 128x64" % path)
+            frames.append(rows)
+    return frames
+
+
+def encode(frames, fps):
+    out = bytearray(b"SA" + bytes((VERSION, fps)) +
+                    struct.pack("<HH", len(frames), 0))
+    prev = None
+    for rows in frames:
+        cur = gram_bytes(rows)
+        out.extend(encode_frame(prev, cur))
+        prev = cur
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--fps", type=int, default=20,
+                        help="playback frame rate (default 20)")
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("-o", "--output", help="write the stream to a file")
+    group.add_argument("--name", help="write a C array of this name to stdout")
+    parser.add_argument("frames", nargs="+", help="PBM frames, in order")
+    args = parser.parse_args()
+
+    if not 0 < args.fps < 256:
+        parser.error("fps must be 1..255")
+    frames = read_frames(args.frames)
+    if len(frames) > 0xFFFF:
+        parser.error("too many frames")
+    blob = encode(frames, args.fps)
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(blob)
+    else:
+        sys.stdout.write(ssd1306_rle.c_array(args.name, blob))
+    sys.stderr.write("%d frames: %d -> %d bytes\n" %
+                     (len(frames), len(frames) * WIDTH * PAGES, len(blob)))
+
+
+if __name__ == "__main__":
+    main()
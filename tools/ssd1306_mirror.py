@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2025 Subalpine Circuits
+#
+# SPDX-License-Identifier: Apache-2.0
+"""Rebuild the frames of an ssd1306_mirror capture as 128x64 PBM images.
+
+    ssd1306_mirror.py capture.bin -o frame      # frame0000.pbm, ...
+    ssd1306_mirror.py capture.bin > frames.pbm  # concatenated P4 images
+
+The capture is the mirror frames as the callback received them, written back
+to back; an ssd1306_anim stream, header included, decodes the same way.
+Decoding starts from a blank panel, so frames before the first keyframe show
+only what changed.
+"""
+
+import argparse
+import sys
+
+WIDTH = 128
+HEIGHT = 64
+PAGES = 8
+
+
+def _window(data, pos, size):
+    """Decompress size bytes starting at pos; return them and the position
+    after the compressed data."""
+    out = bytearray()
+    while len(out) < size:
+        op = data[pos]
+        if op & 0x80:
+            out.extend(data[pos + 1:pos + 2] * ((op & 0x7F) + 2))
+            pos += 2
+        else:
+            out.extend(data[pos + 1:pos + 2 + op])
+            pos += op + 2
+    if pos > len(data) or len(out) != size:
+        raise ValueError("truncated window")
+    return out, pos
+
+
+def decode(data):
+    """Yield the GRAM, gram[x][page], after each frame."""
+    gram = [[0] * PAGES for _ in range(WIDTH)]
+    pos = 8 if data[:2] == b"SA" else 0
+    while pos < len(data):
+        count = data[pos]
+        pos += 1
+        for _ in range(count):
+            if pos + 4 > len(data):
+                raise ValueError("truncated frame")
+            c0, c1, p0, p1 = data[pos:pos + 4]
+            if c0 > c1 or c1 >= WIDTH or p0 > p1 or p1 >= PAGES:
+                raise ValueError("bad window at offset %d" % pos)
+            pages = p1 - p0 + 1
+            raw, pos = _window(data, pos + 4, (c1 - c0 + 1) * pages)
+            for i, x in enumerate(range(c0, c1 + 1)):
+                gram[x][p0:p1 + 1] = raw[i * pages:(i + 1) * pages]
+        yield gram
+
+
+def pbm(gram):
+    """P4 image of a GRAM: pixel row y is in hardware page 7 - y // 8,
+    bit 7 - y % 8."""
+    out = bytearray(b"P4\n%d %d\n" % (WIDTH, HEIGHT))
+    for y in range(HEIGHT):
+        page, bit = PAGES - 1 - y // 8, 0x80 >> (y % 8)
+        for x0 in range(0, WIDTH, 8):
+            byte = 0
+            for x in range(x0, x0 + 8):
+                byte = byte << 1 | bool(gram[x][page] & bit)
+            out.append(byte)
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-o", "--output",
+                        help="write PREFIXnnnn.pbm per frame instead of "
+                        "concatenated images to stdout")
+    parser.add_argument("capture", help="captured mirror frames")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        data = f.read()
+    frames = 0
+    for gram in decode(data):
+        image = pbm(gram)
+        if args.output:
+            with open("%s%04d.pbm" % (args.output, frames), "wb") as f:
+                f.write(image)
+        else:
+            sys.stdout.buffer.write(image)
+        frames += 1
+    sys.stderr.write("%d frames from %d bytes\n" % (frames, len(data)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2025 Subalpine Circuits
+#
+# SPDX-License-Identifier: Apache-2.0
+"""Compress PBM images for ssd1306_draw_rle_bitmap.
+
+    ssd1306_rle.py splash.pbm splash > splash.h
+    ssd1306_rle.py --bin splash.pbm splash.rle
+
+The format is described in include/ssd1306_rle.h. Images must be at most
+128x64 pixels.
+"""
+
+import argparse
+import sys
+
+MAX_WIDTH = 128
+MAX_HEIGHT = 64
+
+
+def _pbm_tokens(data, pos, count):
+    """Read count whitespace-separated header tokens, skipping comments."""
+    tokens = []
+    while len(tokens) < count:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            while data[pos:pos + 1] not in (b"\n", b""):
+                pos += 1
+            continue
+        start = pos
+        while pos < len(data) and not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    return tokens, pos
+
+
+def read_pbm(data, pos=0):
+    """Parse one P1 or P4 image starting at pos.
+
+    Returns (width, height, rows, next_pos) where rows[y][x] is 1 for a set
+    (black) pixel.
+    """
+    (magic, w, h), pos = _pbm_tokens(data, pos, 3)
+    width, height = int(w), int(h)
+    rows = []
+    if magic == b"P4":
+        pos += 1  # single whitespace after the header
+        stride = (width + 7) // 8
+        for y in range(height):
+            line = data[pos + y * stride:pos + (y + 1) * stride]
+            rows.append([(line[x // 8] >> (7 - x % 8)) & 1
+                         for x in range(width)])
+        pos += stride * height
+    elif magic == b"P1":
+        bits = []
+        while len(bits) < width * height:
+            c = data[pos:pos + 1]
+            if c in (b"0", b"1"):
+                bits.append(int(c))
+            elif c == b"#":
+                while data[pos:pos + 1] not in (b"\n", b""):
+                    pos += 1
+            elif c == b"":
+                raise ValueError("truncated P1 image")
+            pos += 1
+        rows = [bits[y * width:(y + 1) * width] for y in range(height)]
+    else:
+        raise ValueError("not a PBM image: %r" % magic)
+    return width, height, rows, pos
+
+
+def read_pbm_file(path):
+    with open(path, "rb") as f:
+        width, height, rows, _ = read_pbm(f.read())
+    return width, height, rows
+
+
+def native_bytes(width, height, rows):
+    """Image bytes in the panel's order: column by column, top stripe first,
+    topmost row of each stripe in bit 7."""
+    out = bytearray()
+    for x in range(width):
+        for stripe in range((height + 7) // 8):
+            byte = 0
+            for bit in range(8):
+                y = stripe * 8 + bit
+                if y < height and rows[y][x]:
+                    byte |= 0x80 >> bit
+            out.append(byte)
+    return bytes(out)
+
+
+def compress(data):
+    """PackBits-style encoding: runs of 2..129 equal bytes, literals of
+    1..128 bytes."""
+    out = bytearray()
+    literal = bytearray()
+
+    def flush():
+        if literal:
+            out.append(len(literal) - 1)
+            out.extend(literal)
+            literal.clear()
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 129 and data[i + run] == data[i]:
+            run += 1
+        # a two-byte run only pays off if it doesn't split a literal
+        if run >= 3 or (run == 2 and not literal):
+            flush()
+            out.append(0x80 | (run - 2))
+            out.append(data[i])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+            if len(literal) == 128:
+                flush()
+    flush()
+    return bytes(out)
+
+
+def decompress(data, size):
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        op = data[i]
+        if op & 0x80:
+            out.extend(data[i + 1:i + 2] * ((op & 0x7F) + 2))
+            i += 2
+        else:
+            out.extend(data[i + 1:i + 2 + op])
+            i += op + 2
+    return bytes(out[:size])
+
+
+def encode_image(width, height, rows):
+    if not 0 < width <= MAX_WIDTH or not 0 < height <= MAX_HEIGHT:
+        raise ValueError("image must be at most %dx%d" % (MAX_WIDTH,
+                                                          MAX_HEIGHT))
+    raw = native_bytes(width, height, rows)
+    packed = compress(raw)
+    assert decompress(packed, len(raw)) == raw
+    return bytes([width, height]) + packed
+
+
+def c_array(name, blob):
+    lines = ["static const uint8_t %s[%d] = {" % (name, len(blob))]
+    for i in range(0, len(blob), 12):
+        lines.append("    " + ", ".join("0x%02x" % b for b in blob[i:i + 12])
+                     + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--bin", action="store_true",
+                        help="write the raw blob to OUTPUT instead of a C "
+                        "array to stdout")
+    parser.add_argument("image", help="input PBM image (P1 or P4)")
+    parser.add_argument("name", help="C array name, or output path with --bin")
+    args = parser.parse_args()
+
+    width, height, rows = read_pbm_file(args.image)
+    blob = encode_image(width, height, rows)
+    if args.bin:
+        with open(args.name, "wb") as f:
+            f.write(blob)
+    else:
+        sys.stdout.write(c_array(args.name, blob))
+    raw = (width * ((height + 7) // 8))
+    sys.stderr.write("%dx%d: %d -> %d bytes\n" % (width, height, raw,
+                                                    len(blob)))
+
+
+if __name__ == "__main__":
+    main()